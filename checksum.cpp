@@ -33,8 +33,58 @@
  *********************************************************************/
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <cstdint>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <chrono>
+#include <atomic>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <filesystem>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <random>
+#include <iomanip>
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#if defined(CHECKSUM_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(CHECKSUM_ZLIB_ABI) && (defined(__unix__) || defined(__APPLE__))
+#include <dlfcn.h>
+#endif
 
 using namespace std;
 
@@ -56,10 +106,12 @@ Documentatie/catalog CRC-uri: https://reveng.sourceforge.io/crc-catalogue/all.ht
  CRC-7/MMC                  0x09                Non-Reversed/Non-Reflected           0                    Nu. (0x0000)
  CRC-16/ARC                0xA001                   Reversed/Reflected               0                    Nu. (0x0000)
  CRC-32/ISO-HDLC         0xEDB88320                 Reversed/Reflected           0xFFFFFFFF              Da. (0xFFFFFFFF)
+ CRC-64/XZ          0xC96C5795D7870F42              Reversed/Reflected       0xFFFFFFFFFFFFFFFF      Da. (0xFFFFFFFFFFFFFFFF)
 
 */
 
 #define SIZE 256 /* Numarul de constante din tabelele de cautare. */
+#define polinomCRC64 0xC96C5795D7870F42ull /* Folosit pentru indexul de deduplicare, unde 32 de biti ar da prea multe coliziuni. */
 #define polinomCRC32 0xEDB88320 
 #define polinomCRC16 0xA001
 #define polinomCRC7 0x12 /* (0x09) << 1. */
@@ -78,12 +130,14 @@ uint8_t = intreg pe 8 biti fara semn
 Valori posibile: [0, 2^8-1] = [0, 255];
 */
 
+typedef uint64_t CRC64;
 typedef uint32_t CRC32;
 typedef uint16_t CRC16;
 typedef uint8_t CRC7;
 
 /* Intai tabelele de cautare nu sunt initializate. */
 
+bool tabel_CRC64_initializat = false;
 bool tabel_CRC32_initializat = false;
 bool tabel_CRC16_initializat = false;
 bool tabel_CRC7_initializat = false;
@@ -98,10 +152,28 @@ urmatorul octet care urmeaza a fi prelucrat din string-ul de intrare, putem sa c
 Urmatoare valoare care urmeaza a fi adaugata la codul CRC este determinata facand XOR intre octetul cel mai semnificativ din CRC si octetul la care ne aflam in string-ul de intrare.
 Valoarea obtinuta in urma operatiei de XOR va incepe mereu practic cu un bit de 0, deoarece 1 XOR 1 este 0. */
 
+CRC64 tabel_CRC64[SIZE];
 CRC32 tabel_CRC32[SIZE];
 CRC16 tabel_CRC16[SIZE];
 CRC7 tabel_CRC7[SIZE];
 
+void initializare_tabel64() {
+    CRC64 octet = 0;
+    tabel_CRC64_initializat = true;
+    for (CRC64 deimpartit = 0; deimpartit < SIZE; deimpartit++) {
+        octet = deimpartit;
+        for (CRC64 bit = 0; bit < 8; bit++) {
+            if (octet & 1) {
+                octet >>= 1;
+                octet ^= polinomCRC64;
+            }
+            else
+                octet >>= 1;
+        }
+        tabel_CRC64[deimpartit] = octet;
+    }
+}
+
 void initializare_tabel32() {
     CRC32 octet = 0;
     tabel_CRC32_initializat = true;
@@ -156,32 +228,444 @@ void initializare_tabel7() {
     }
 }
 
-CRC32 calculCRC32(string input) {
-    CRC32 rezultat = 0xFFFFFFFF; /* Valoarea initiala stocata in registru, 32 de 1. */
+/* Sonde statice USDT (User Statically-Defined Tracing), pentru observarea programului in timpul rularii, fara recompilare:
+    bpftrace -e 'usdt:./checksum:checksum:update_entry { @dimensiuni = hist(arg1); }'
+Daca <sys/sdt.h> exista (pachetul systemtap-sdt-dev), fiecare sonda devine o singura instructiune NOP plus o nota in fisierul ELF;
+argumentele nu sunt evaluate separat, ci doar descrise pentru instrumentul de trasare. Fara acest antet, sau cu -DCHECKSUM_FARA_USDT,
+sondele nu genereaza niciun cod.
+
+Sonde: kernel_select(algoritm, kernel, lungime), update_entry/update_exit(algoritm, lungime),
+batch_dispatch(clasa, lungime coada), bulk_split(lungime, numar felii), file_done(cale, octeti, crc). */
+
+#if !defined(CHECKSUM_FARA_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define SONDE_USDT
+#endif
+#endif
+
+#if defined(SONDE_USDT)
+#define SONDA2(nume, a, b) DTRACE_PROBE2(checksum, nume, a, b)
+#define SONDA3(nume, a, b, c) DTRACE_PROBE3(checksum, nume, a, b, c)
+#else
+#define SONDA2(nume, a, b) ((void)0)
+#define SONDA3(nume, a, b, c) ((void)0)
+#endif
+
+/* Metrici de functionare (contoare si indicatori), exportate in formatul text Prometheus.
+Contoarele sunt atomice si se actualizeaza cu memory_order_relaxed: nu ordoneaza nimic, doar numara. */
+
+enum AlgoritmCRC { algoritm_crc32, algoritm_crc16, algoritm_crc7, algoritm_crc64, numar_algoritmi };
+const char* nume_algoritmi[numar_algoritmi] = { "crc32", "crc16", "crc7", "crc64" };
+
+/* Implementarile (kernel-urile) disponibile pentru un algoritm.
+"multibuffer" calculeaza CRC-urile mai multor mesaje independente in aceeasi bucla si nu este ales de actualizareCRC.
+"intercalat" imparte un singur mesaj lung in mai multe fluxuri parcurse in aceeasi bucla (CRC32 si CRC16).
+"pliere" este plierea PCLMUL a motoarelor MotorCRC, pentru modelele reflectate (CRC32, CRC16, CRC64), pe procesoarele care o au. */
+enum KernelCRC { kernel_tabel, kernel_multibuffer, kernel_intercalat, kernel_pliere, numar_kerneluri };
+const char* nume_kerneluri[numar_kerneluri] = { "tabel", "multibuffer", "intercalat", "pliere" };
 
-    for (size_t bit = 0; bit < input.length(); bit++) {
-        CRC32 termen = (input[bit] ^ rezultat) & 0xFF;
+struct Metrici {
+    atomic<uint64_t> octeti[numar_algoritmi] = {};
+    atomic<uint64_t> selectii_kernel[numar_algoritmi][numar_kerneluri] = {};
+    atomic<uint64_t> nepotriviri{ 0 };      /* Coduri CRC (si lungimi ISIZE gzip) gasite diferite de cele asteptate, in modurile de verificare. */
+    atomic<uint64_t> fisiere{ 0 };
+    atomic<uint64_t> erori_citire{ 0 };
+    atomic<uint64_t> timp_citire_ns{ 0 };   /* Timp petrecut in citiri (I/O). */
+    atomic<uint64_t> timp_calcul_ns{ 0 };   /* Timp petrecut in calculul CRC din conducta. */
+    atomic<int64_t> coada_blocuri{ 0 };     /* Adancimea cozilor din conducta pentru fisiere. */
+    atomic<int64_t> coada_rezultate{ 0 };
+};
+
+Metrici metrici;
+
+uint64_t nanosecundeDeLa(chrono::steady_clock::time_point inceput) {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - inceput).count();
+}
+
+/* Functiile "actualizare" primesc starea curenta a registrului si un bloc de octeti si intorc starea noua,
+fara valoarea initiala si fara XOR-ul final. Astfel un sir lung poate fi prelucrat pe bucati (streaming),
+iar functiile calculCRC de mai jos sunt doar cazul particular in care tot sirul este o singura bucata.
+Fiecare actualizare alege kernel-ul potrivit pentru lungimea data si il numara in metrici. */
+
+CRC32 kernelTabelCRC32(CRC32 rezultat, const unsigned char* date, size_t lungime) {
+    for (size_t bit = 0; bit < lungime; bit++) {
+        CRC32 termen = (date[bit] ^ rezultat) & 0xFF;
         rezultat = (rezultat >> 8) ^ tabel_CRC32[termen];
     }
+    return rezultat;
+}
+
+CRC16 kernelTabelCRC16(CRC16 rezultat, const unsigned char* date, size_t lungime) {
+    for (size_t bit = 0; bit < lungime; bit++) {
+        CRC16 termen = (date[bit] ^ rezultat) & 0xFF;
+        rezultat = (rezultat >> 8) ^ tabel_CRC16[termen];
+    }
+    return rezultat;
+}
+
+CRC64 kernelTabelCRC64(CRC64 rezultat, const unsigned char* date, size_t lungime) {
+    for (size_t bit = 0; bit < lungime; bit++) {
+        CRC64 termen = (date[bit] ^ rezultat) & 0xFF;
+        rezultat = (rezultat >> 8) ^ tabel_CRC64[termen];
+    }
+    return rezultat;
+}
+
+/* Pentru CRC7 starea este registrul pe 8 biti (CRC-ul shiftat cu o pozitie spre stanga). */
+CRC7 kernelTabelCRC7(CRC7 rezultat, const unsigned char* date, size_t lungime) {
+    for (size_t bit = 0; bit < lungime; bit++)
+        rezultat = tabel_CRC7[rezultat ^ date[bit]]; /* Octetii sunt fara semn, altfel un caracter >= 0x80 ar da un index negativ. */
+    return rezultat;
+}
+
+/* Kernel intercalat pentru un singur mesaj lung (fara PCLMUL si pe un singur fir).
+In kernel-ul cu tabel fiecare octet asteapta rezultatul citirii din tabel pentru octetul anterior, deci procesorul sta mai mult
+dupa latenta acestui lant decat lucreaza. Aici mesajul este impartit in NUMAR_FLUXURI felii egale, parcurse in aceeasi bucla:
+cele NUMAR_FLUXURI lanturi sunt independente si se suprapun. La final registrele se lipesc prin combinare
+(R = R_anterior * x^(8 * felie) mod P  XOR  R_felie, cu o singura putere, felii fiind egale), iar restul se termina cu tabelul. */
+#define NUMAR_FLUXURI 4
+
+template<typename T> T inmultireModP(T a, T b, T polinom);
+template<typename T, T polinom> T putereX8n(uint64_t n);
+
+template<typename T, T polinom>
+T kernelIntercalat(T rezultat, const unsigned char* date, size_t lungime, const T tabel[SIZE]) {
+    size_t felie = lungime / NUMAR_FLUXURI;
+    const unsigned char* p0 = date;
+    const unsigned char* p1 = date + felie;
+    const unsigned char* p2 = date + 2 * felie;
+    const unsigned char* p3 = date + 3 * felie;
+    T r0 = rezultat, r1 = 0, r2 = 0, r3 = 0; /* Feliile 1..3 incep cu registrul 0; valoarea initiala ajunge in ele prin combinare. */
+    for (size_t i = 0; i < felie; i++) {
+        r0 = (T)((r0 >> 8) ^ tabel[(p0[i] ^ r0) & 0xFF]);
+        r1 = (T)((r1 >> 8) ^ tabel[(p1[i] ^ r1) & 0xFF]);
+        r2 = (T)((r2 >> 8) ^ tabel[(p2[i] ^ r2) & 0xFF]);
+        r3 = (T)((r3 >> 8) ^ tabel[(p3[i] ^ r3) & 0xFF]);
+    }
+    if (felie) {
+        T putere = putereX8n<T, polinom>(felie);
+        rezultat = (T)(inmultireModP<T>(putere, r0, polinom) ^ r1);
+        rezultat = (T)(inmultireModP<T>(putere, rezultat, polinom) ^ r2);
+        rezultat = (T)(inmultireModP<T>(putere, rezultat, polinom) ^ r3);
+    }
+    for (size_t i = NUMAR_FLUXURI * felie; i < lungime; i++)
+        rezultat = (T)((rezultat >> 8) ^ tabel[(date[i] ^ rezultat) & 0xFF]);
+    return rezultat;
+}
+
+CRC32 kernelIntercalatCRC32(CRC32 rezultat, const unsigned char* date, size_t lungime) {
+    return kernelIntercalat<CRC32, polinomCRC32>(rezultat, date, lungime, tabel_CRC32);
+}
+
+CRC16 kernelIntercalatCRC16(CRC16 rezultat, const unsigned char* date, size_t lungime) {
+    return kernelIntercalat<CRC16, polinomCRC16>(rezultat, date, lungime, tabel_CRC16);
+}
+
+/* Histograme HDR (High Dynamic Range) pentru latenta apelurilor CRC.
+O medie de debit ascunde varfurile din coada distributiei (ex.: un apel scurt care asteapta dupa un cache miss in tabel_CRC32),
+asa ca fiecare apel poate fi inregistrat intr-o histograma log-liniara: fiecare putere a lui 2 este impartita in 2^BITI_SUBGRUP
+intervale egale, deci orice valoare este pastrata cu o eroare relativa de cel mult 1 / 2^BITI_SUBGRUP (~3%).
+Fiecare fir are histogramele lui (fara blocari la inregistrare), iar la afisare ele se combina. */
+
+#define BITI_SUBGRUP 5
+#define NUMAR_INTERVALE_HDR ((65 - BITI_SUBGRUP) << BITI_SUBGRUP)
+
+class HistogramaHDR {
+public:
+    /* Un singur fir scrie intr-o histograma, dar alte fire o pot citi oricand, de aceea contoarele sunt atomice
+    (citire + scriere relaxata, fara instructiuni de blocare). */
+    void inregistreaza(uint64_t valoare) {
+        atomic<uint64_t>& contor = contoare[indexInterval(valoare)];
+        contor.store(contor.load(memory_order_relaxed) + 1, memory_order_relaxed);
+        if (valoare > maxim.load(memory_order_relaxed))
+            maxim.store(valoare, memory_order_relaxed);
+    }
+
+    void combina(const HistogramaHDR& alta) {
+        for (int i = 0; i < NUMAR_INTERVALE_HDR; i++)
+            contoare[i].fetch_add(alta.contoare[i].load(memory_order_relaxed), memory_order_relaxed);
+        maxim.store(max(maxim.load(memory_order_relaxed), alta.maxim.load(memory_order_relaxed)), memory_order_relaxed);
+    }
+
+    uint64_t numar() const {
+        uint64_t total = 0;
+        for (int i = 0; i < NUMAR_INTERVALE_HDR; i++)
+            total += contoare[i].load(memory_order_relaxed);
+        return total;
+    }
+
+    /* Valoarea sub care se afla "procent" la suta din inregistrari (limita superioara a intervalului gasit). */
+    uint64_t percentila(double procent) const {
+        uint64_t total = numar();
+        if (!total)
+            return 0;
+        uint64_t prag = max<uint64_t>(1, (uint64_t)ceil(procent / 100 * total)), cumulat = 0;
+        for (int i = 0; i < NUMAR_INTERVALE_HDR; i++) {
+            cumulat += contoare[i].load(memory_order_relaxed);
+            if (cumulat >= prag)
+                return min(limitaSuperioara(i), maxim.load(memory_order_relaxed));
+        }
+        return maxim.load(memory_order_relaxed);
+    }
+
+    uint64_t valoareMaxima() const { return maxim.load(memory_order_relaxed); }
+
+private:
+    static int indexInterval(uint64_t valoare) {
+        if (valoare < (1u << BITI_SUBGRUP))
+            return (int)valoare;
+        int exponent = 63 - __builtin_clzll(valoare);
+        uint64_t subinterval = valoare >> (exponent - BITI_SUBGRUP); /* Intre 2^BITI_SUBGRUP si 2^(BITI_SUBGRUP+1) - 1. */
+        return ((exponent - BITI_SUBGRUP + 1) << BITI_SUBGRUP) + (int)(subinterval - (1u << BITI_SUBGRUP));
+    }
+
+    static uint64_t limitaSuperioara(int index) {
+        if (index < (1 << BITI_SUBGRUP))
+            return (uint64_t)index;
+        int grupa = index >> BITI_SUBGRUP;
+        uint64_t subinterval = (uint64_t)(index & ((1 << BITI_SUBGRUP) - 1)) + (1u << BITI_SUBGRUP);
+        return ((subinterval + 1) << (grupa - 1)) - 1;
+    }
+
+    atomic<uint64_t> contoare[NUMAR_INTERVALE_HDR] = {};
+    atomic<uint64_t> maxim{ 0 };
+};
+
+/* Clasele de dimensiune ale mesajelor pentru care se tin histograme separate. */
+enum ClasaDimensiune { dim_16, dim_64, dim_256, dim_1k, dim_4k, dim_64k, dim_1m, dim_mare, numar_clase_dimensiune };
+const char* nume_clase_dimensiune[numar_clase_dimensiune] = { "<16 B", "<64 B", "<256 B", "<1 KB", "<4 KB", "<64 KB", "<1 MB", ">=1 MB" };
+
+ClasaDimensiune clasaDimensiune(size_t lungime) {
+    const size_t limite[numar_clase_dimensiune - 1] = { 16, 64, 256, 1024, 4096, 65536, 1048576 };
+    for (int clasa = 0; clasa < numar_clase_dimensiune - 1; clasa++)
+        if (lungime < limite[clasa])
+            return (ClasaDimensiune)clasa;
+    return dim_mare;
+}
+
+/* Inregistrarea este oprita implicit: cand este pornita, fiecare apel costa doua citiri ale ceasului. */
+atomic<bool> histograme_active{ false };
+
+struct HistogrameFir {
+    unique_ptr<HistogramaHDR> histograme[numar_algoritmi][numar_clase_dimensiune];
+};
+
+/* Toate histogramele tuturor firelor. Ele nu se sterg la terminarea unui fir, ca datele sa poata fi combinate si dupa. */
+mutex m_histograme;
+vector<unique_ptr<HistogrameFir>> histograme_fire;
+
+HistogramaHDR& histogramaFir(AlgoritmCRC algoritm, ClasaDimensiune clasa) {
+    thread_local HistogrameFir* ale_firului = [] {
+        lock_guard<mutex> blocare(m_histograme);
+        histograme_fire.push_back(make_unique<HistogrameFir>());
+        return histograme_fire.back().get();
+    }();
+    unique_ptr<HistogramaHDR>& histograma = ale_firului->histograme[algoritm][clasa];
+    if (!histograma) {
+        lock_guard<mutex> blocare(m_histograme); /* Alocarea se face sub blocare, ca sa nu se suprapuna cu o combinare. */
+        histograma = make_unique<HistogramaHDR>();
+    }
+    return *histograma;
+}
+
+/* Combina histogramele tuturor firelor pentru un algoritm si o clasa de dimensiune. */
+void histogramaCombinata(AlgoritmCRC algoritm, ClasaDimensiune clasa, HistogramaHDR& rezultat) {
+    lock_guard<mutex> blocare(m_histograme);
+    for (unique_ptr<HistogrameFir>& fir : histograme_fire)
+        if (fir->histograme[algoritm][clasa])
+            rezultat.combina(*fir->histograme[algoritm][clasa]);
+}
+
+/* Masoara durata unui apel (de la constructie la distrugere), doar daca histogramele sunt active. */
+class MasurareLatenta {
+public:
+    MasurareLatenta(AlgoritmCRC algoritm, size_t lungime) : algoritm(algoritm), lungime(lungime), activa(histograme_active.load(memory_order_relaxed)) {
+        SONDA2(update_entry, (int)algoritm, lungime);
+        if (activa)
+            inceput = chrono::steady_clock::now();
+    }
+
+    ~MasurareLatenta() {
+        SONDA2(update_exit, (int)algoritm, lungime);
+        if (activa)
+            histogramaFir(algoritm, clasaDimensiune(lungime)).inregistreaza(nanosecundeDeLa(inceput));
+    }
+
+private:
+    AlgoritmCRC algoritm;
+    size_t lungime;
+    bool activa;
+    chrono::steady_clock::time_point inceput;
+};
+
+void afisarePercentile(ostream& iesire) {
+    iesire << "Latente apeluri CRC (ns), pe algoritm si clasa de dimensiune:" << endl;
+    for (int algoritm = 0; algoritm < numar_algoritmi; algoritm++)
+        for (int clasa = 0; clasa < numar_clase_dimensiune; clasa++) {
+            HistogramaHDR h;
+            histogramaCombinata((AlgoritmCRC)algoritm, (ClasaDimensiune)clasa, h);
+            uint64_t numar = h.numar();
+            if (!numar)
+                continue;
+            iesire << dec << nume_algoritmi[algoritm] << " " << nume_clase_dimensiune[clasa] << ": " << numar << " apeluri"
+                << ", p50 " << h.percentila(50) << ", p90 " << h.percentila(90) << ", p99 " << h.percentila(99)
+                << ", p99.9 " << h.percentila(99.9) << ", max " << h.valoareMaxima() << endl;
+        }
+}
+
+/* Kernel multi-buffer pentru CRC32: 4 mesaje independente sunt avansate in aceeasi bucla, cate un octet din fiecare.
+Cele 4 lanturi de cautari in tabel nu depind unul de altul, deci procesorul le poate executa suprapus, in loc sa astepte
+dupa fiecare cautare ca in kernel-ul simplu. Ce ramane din mesajele mai lungi se termina cu kernel-ul simplu.
+"stari" contine la intrare starile initiale ale registrelor si la iesire starile finale. */
+#define NUMAR_BUFFERE 4
+
+void kernelMultiBufferCRC32(const unsigned char* const date[NUMAR_BUFFERE], const size_t lungimi[NUMAR_BUFFERE], CRC32 stari[NUMAR_BUFFERE]) {
+    size_t comun = min(min(lungimi[0], lungimi[1]), min(lungimi[2], lungimi[3]));
+    CRC32 r0 = stari[0], r1 = stari[1], r2 = stari[2], r3 = stari[3];
+    const unsigned char *d0 = date[0], *d1 = date[1], *d2 = date[2], *d3 = date[3];
+    for (size_t i = 0; i < comun; i++) {
+        r0 = (r0 >> 8) ^ tabel_CRC32[(r0 ^ d0[i]) & 0xFF];
+        r1 = (r1 >> 8) ^ tabel_CRC32[(r1 ^ d1[i]) & 0xFF];
+        r2 = (r2 >> 8) ^ tabel_CRC32[(r2 ^ d2[i]) & 0xFF];
+        r3 = (r3 >> 8) ^ tabel_CRC32[(r3 ^ d3[i]) & 0xFF];
+    }
+    stari[0] = r0; stari[1] = r1; stari[2] = r2; stari[3] = r3;
+    for (int b = 0; b < NUMAR_BUFFERE; b++)
+        stari[b] = kernelTabelCRC32(stari[b], date[b] + comun, lungimi[b] - comun);
+}
+
+/* Urma apelurilor de actualizare (algoritm, lungime, aliniere), pentru reluarea lor in modul benchmark.
+Inregistrarea este oprita implicit; cand este pornita, fiecare apel costa doua incrementari atomice, iar dupa umplerea
+capacitatii apelurile doar se numara. */
+struct IntrareUrma {
+    uint64_t lungime;
+    uint8_t algoritm;
+    uint8_t aliniere;   /* Adresa datelor modulo 64 (pozitia in linia de cache). */
+};
+
+struct UrmaApeluri {
+    atomic<bool> activa{ false };
+    vector<IntrareUrma> intrari;
+    atomic<size_t> rezervate{ 0 };
+    atomic<size_t> scrise{ 0 };
+};
+UrmaApeluri urma_apeluri;
+
+void inregistreazaApel(AlgoritmCRC algoritm, const unsigned char* date, size_t lungime) {
+    size_t i = urma_apeluri.rezervate.fetch_add(1, memory_order_relaxed);
+    if (i >= urma_apeluri.intrari.size())
+        return;
+    urma_apeluri.intrari[i] = { lungime, (uint8_t)algoritm, (uint8_t)((uintptr_t)date & 63) };
+    urma_apeluri.scrise.fetch_add(1, memory_order_release);
+}
+
+/* Nu trebuie apelata cat timp inregistrarea este pornita. */
+void pornesteUrma(size_t capacitate) {
+    urma_apeluri.intrari.assign(capacitate, IntrareUrma{});
+    urma_apeluri.rezervate.store(0);
+    urma_apeluri.scrise.store(0);
+    urma_apeluri.activa.store(true, memory_order_release);
+}
+
+/* Opreste inregistrarea si intoarce apelurile retinute; "pierdute" = apelurile de dupa umplerea capacitatii. */
+vector<IntrareUrma> opresteUrma(uint64_t& pierdute) {
+    urma_apeluri.activa.store(false);
+    size_t rezervate = urma_apeluri.rezervate.load();
+    size_t retinute = min(rezervate, urma_apeluri.intrari.size());
+    /* Un fir care a rezervat o pozitie inainte de oprire poate fi inca in mijlocul scrierii ei. */
+    while (urma_apeluri.scrise.load(memory_order_acquire) < retinute)
+        this_thread::yield();
+    pierdute = rezervate - retinute;
+    return vector<IntrareUrma>(urma_apeluri.intrari.begin(), urma_apeluri.intrari.begin() + retinute);
+}
+
+/* De la acest prag (in octeti) CRC32 si CRC16 folosesc kernel-ul intercalat; sub el combinarea costa mai mult decat castiga. */
+#define PRAG_INTERCALARE 256
+
+/* Sub acest prag (in octeti) pregatirea plierii costa mai mult decat tabelul. */
+#define PRAG_PLIERE 64
+
+/* Plierea cere PCLMULQDQ (si SSSE3); CRC7 nu este reflectat si ramane la tabel. */
+bool pliereDisponibila(AlgoritmCRC algoritm) {
+#if defined(__x86_64__)
+    static const bool procesor = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+    return algoritm != algoritm_crc7 && procesor;
+#else
+    (void)algoritm;
+    return false;
+#endif
+}
+
+/* Definit dupa MotorCRC. */
+uint64_t kernelPliere(AlgoritmCRC algoritm, uint64_t stare, const unsigned char* date, size_t lungime);
+
+KernelCRC alegeKernel(AlgoritmCRC algoritm, const unsigned char* date, size_t lungime) {
+    KernelCRC kernel = lungime >= PRAG_PLIERE && pliereDisponibila(algoritm) ? kernel_pliere
+        : (algoritm == algoritm_crc32 || algoritm == algoritm_crc16) && lungime >= PRAG_INTERCALARE ? kernel_intercalat : kernel_tabel;
+    if (urma_apeluri.activa.load(memory_order_relaxed))
+        inregistreazaApel(algoritm, date, lungime);
+    SONDA3(kernel_select, (int)algoritm, (int)kernel, lungime);
+    metrici.octeti[algoritm].fetch_add(lungime, memory_order_relaxed);
+    metrici.selectii_kernel[algoritm][kernel].fetch_add(1, memory_order_relaxed);
+    return kernel;
+}
+
+CRC32 actualizareCRC32(CRC32 rezultat, const unsigned char* date, size_t lungime) {
+    MasurareLatenta masurare(algoritm_crc32, lungime);
+    switch (alegeKernel(algoritm_crc32, date, lungime)) {
+    case kernel_pliere: return (CRC32)kernelPliere(algoritm_crc32, rezultat, date, lungime);
+    case kernel_intercalat: return kernelIntercalatCRC32(rezultat, date, lungime);
+    default: return kernelTabelCRC32(rezultat, date, lungime);
+    }
+}
+
+CRC16 actualizareCRC16(CRC16 rezultat, const unsigned char* date, size_t lungime) {
+    MasurareLatenta masurare(algoritm_crc16, lungime);
+    switch (alegeKernel(algoritm_crc16, date, lungime)) {
+    case kernel_pliere: return (CRC16)kernelPliere(algoritm_crc16, rezultat, date, lungime);
+    case kernel_intercalat: return kernelIntercalatCRC16(rezultat, date, lungime);
+    default: return kernelTabelCRC16(rezultat, date, lungime);
+    }
+}
+
+CRC7 actualizareCRC7(CRC7 rezultat, const unsigned char* date, size_t lungime) {
+    MasurareLatenta masurare(algoritm_crc7, lungime);
+    switch (alegeKernel(algoritm_crc7, date, lungime)) {
+    default: return kernelTabelCRC7(rezultat, date, lungime);
+    }
+}
+
+CRC64 actualizareCRC64(CRC64 rezultat, const unsigned char* date, size_t lungime) {
+    MasurareLatenta masurare(algoritm_crc64, lungime);
+    switch (alegeKernel(algoritm_crc64, date, lungime)) {
+    case kernel_pliere: return kernelPliere(algoritm_crc64, rezultat, date, lungime);
+    default: return kernelTabelCRC64(rezultat, date, lungime);
+    }
+}
 
+CRC32 calculCRC32(const string& input) {
+    CRC32 rezultat = 0xFFFFFFFF; /* Valoarea initiala stocata in registru, 32 de 1. */
+
+    rezultat = actualizareCRC32(rezultat, (const unsigned char*)input.data(), input.length());
     return rezultat ^ 0xFFFFFFFF; /* sau: ~rezultat. */
 }
 
-CRC16 calculCRC16(string input) {
+CRC64 calculCRC64(const string& input) {
+    return actualizareCRC64(0xFFFFFFFFFFFFFFFFull, (const unsigned char*)input.data(), input.length()) ^ 0xFFFFFFFFFFFFFFFFull;
+}
+
+CRC16 calculCRC16(const string& input) {
     CRC16 rezultat = 0; /* Valoarea initiala este 0. */
-    
-    for (size_t bit = 0; bit < input.length(); bit++) {
-        CRC16 termen = (input[bit] ^ rezultat) & 0xFF;
-        rezultat = (rezultat >> 8) ^ tabel_CRC16[termen];
-    }
+
+    rezultat = actualizareCRC16(rezultat, (const unsigned char*)input.data(), input.length());
     return rezultat; /* Fara XOR. */
 }
 
-CRC7 calculCRC7(string input) {
+CRC7 calculCRC7(const string& input) {
     CRC7 rezultat = 0;
 
-    for (size_t bit = 0; bit < input.length(); bit++)
-         rezultat = tabel_CRC7[rezultat ^ input[bit]];
+    rezultat = actualizareCRC7(rezultat, (const unsigned char*)input.data(), input.length());
     return rezultat >> 1;
     /* Ne intereseaza doar 7 biti din rezultat, iar in main rezultatul va fi casted la Unsigned, ca sa nu fie ignorat primul bit. (daca ar fi 0)
 
@@ -189,58 +673,5446 @@ CRC7 calculCRC7(string input) {
     Daca nu am face cast la Unsigned, s-ar taia primul 0 si ar ramane 111 0101 si luand valoarea lui ASCII ne da 117 = 0xu. */
 }
 
-int main() {
-    enum optiuni { iesire, initializare, calcul_CRC32, calcul_CRC16, calcul_CRC7 };
-    string sir_intrare;
-    int opt;
+/* Modelele CRC, descrise prin parametrii din catalogul reveng (latime, polinom in forma normala, valoare initiala,
+reflectarea intrarii si a iesirii, XOR final si codul sirului "123456789").
+Implementarea de referinta de mai jos urmeaza definitia direct, bit cu bit, fara tabele si fara alte optimizari.
+Ea este lenta, dar evident corecta, si toate kernel-urile rapide sunt comparate cu ea. */
 
-    cout << "Program de calculare a sumei de control folosind codurile CRC." << endl;
-    cout << "Alegeti una dintre optiuni: " << endl;
+struct ModelCRC {
+    const char* nume;
+    int latime;
+    uint64_t polinom;           /* Forma normala (ne-reflectata), fara termenul x^latime. */
+    uint64_t initial;
+    bool reflectat_intrare;
+    bool reflectat_iesire;
+    uint64_t xor_final;
+    uint64_t verificare;        /* CRC-ul sirului ASCII "123456789". */
+};
+
+/* In aceeasi ordine ca AlgoritmCRC. */
+const ModelCRC modele[numar_algoritmi] = {
+    { "CRC-32/ISO-HDLC", 32, 0x04C11DB7, 0xFFFFFFFF, true, true, 0xFFFFFFFF, 0xCBF43926 },
+    { "CRC-16/ARC", 16, 0x8005, 0x0000, true, true, 0x0000, 0xBB3D },
+    { "CRC-7/MMC", 7, 0x09, 0x00, false, false, 0x00, 0x75 },
+    { "CRC-64/XZ", 64, 0x42F0E1EBA9EA3693ull, 0xFFFFFFFFFFFFFFFFull, true, true, 0xFFFFFFFFFFFFFFFFull, 0x995DC9BBDF1939FAull },
+};
+
+uint64_t mascaLatime(int latime) {
+    return latime == 64 ? ~0ull : (1ull << latime) - 1;
+}
+
+/* Inverseaza ordinea celor "latime" biti de jos ai valorii. */
+uint64_t reflecta(uint64_t valoare, int latime) {
+    uint64_t rezultat = 0;
+    for (int i = 0; i < latime; i++, valoare >>= 1)
+        rezultat = (rezultat << 1) | (valoare & 1);
+    return rezultat;
+}
+
+uint64_t calculCRCReferinta(const ModelCRC& model, const unsigned char* date, size_t lungime) {
+    uint64_t masca = mascaLatime(model.latime);
+    uint64_t registru = model.initial & masca;
+    for (size_t i = 0; i < lungime; i++) {
+        uint64_t octet = model.reflectat_intrare ? reflecta(date[i], 8) : date[i];
+        for (int bit = 7; bit >= 0; bit--) { /* Intai bitul cel mai semnificativ al octetului (dupa reflectare). */
+            uint64_t intrare = (octet >> bit) & 1;
+            uint64_t iesit = (registru >> (model.latime - 1)) & 1;
+            registru = (registru << 1) & masca;
+            if (iesit ^ intrare)
+                registru ^= model.polinom;
+        }
+    }
+    if (model.reflectat_iesire)
+        registru = reflecta(registru, model.latime);
+    return (registru ^ model.xor_final) & masca;
+}
+
+/* Motoare de calcul pentru modele CRC inregistrate la executie (din catalog sau date de utilizator), de orice latime intre 1 si 64.
+Orice model de latime w este calculat ca un CRC de 64 de biti cu polinomul P * x^(64-w): registrul de 64 de biti este atunci
+registrul modelului inmultit cu x^(64-w), deci aceeasi cale de calcul (tabel sau pliere) serveste toate latimile.
+Modelele reflectate pastreaza registrul reflectat in bitii de jos; celelalte pastreaza registrul normal aliniat la stanga.
+
+Calea rapida (x86 cu PCLMULQDQ) pliaza cate 4 blocuri de 16 octeti pe iteratie cu inmultiri fara transport si reduce rezultatul
+prin metoda Barrett. Constantele nu sunt scrise de mana pentru fiecare polinom: la inregistrare se calculeaza x^d mod P pentru
+distantele de pliere si mu = floor(x^128 / P). Pliera lucreaza in forma reflectata; pentru modelele nereflectate fiecare octet
+de intrare este oglindit (pshufb), ceea ce transforma CRC-ul nereflectat in CRC-ul reflectat al aceluiasi polinom. */
+
+struct ConstantePliere {
+    uint64_t k[8];          /* k[i] = reflect64(x^(64 * (i + 2) - 1) mod P): distante de pliere 128, 192, ..., 576 de biti. */
+    uint64_t mu;            /* reflect64(floor(x^128 / P) - x^64). */
+    uint64_t polinom;       /* reflect64(P - x^64). */
+};
+
+#if defined(__x86_64__)
+__attribute__((target("pclmul,ssse3"))) static inline __m128i incarcaBloc(const unsigned char* p, bool oglindire) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    if (!oglindire)
+        return v;
+    const __m128i oglinzi = _mm_setr_epi8(0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF);
+    const __m128i jumatate = _mm_set1_epi8(0x0F);
+    __m128i jos = _mm_shuffle_epi8(oglinzi, _mm_and_si128(v, jumatate));
+    __m128i sus = _mm_shuffle_epi8(oglinzi, _mm_and_si128(_mm_srli_epi16(v, 4), jumatate));
+    return _mm_or_si128(_mm_slli_epi16(jos, 4), sus);
+}
+
+/* Inmulteste acumulatorul cu x^d (constantele k_(d+64) in jumatatea de jos, k_d in cea de sus) si adauga blocul. */
+__attribute__((target("pclmul,ssse3"))) static inline __m128i pliaza(__m128i acumulator, __m128i constante, __m128i bloc) {
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(acumulator, constante, 0x00), _mm_clmulepi64_si128(acumulator, constante, 0x11)), bloc);
+}
+
+/* Actualizeaza registrul reflectat (de 64 de biti) cu lungime / 16 blocuri; intoarce numarul de octeti consumati. lungime >= 16. */
+__attribute__((target("pclmul,ssse3"))) size_t actualizarePliere(uint64_t& stare, const unsigned char* date, size_t lungime, const ConstantePliere& c, bool oglindire) {
+    auto distanta = [&](int biti) { return _mm_set_epi64x((long long)c.k[biti / 64 - 2], (long long)c.k[biti / 64 - 1]); };
+    const unsigned char* p = date;
+    __m128i acumulator;
+    if (lungime >= 64) {
+        __m128i x[4];
+        for (int i = 0; i < 4; i++)
+            x[i] = incarcaBloc(p + 16 * i, oglindire);
+        x[0] = _mm_xor_si128(x[0], _mm_cvtsi64_si128((long long)stare));
+        p += 64;
+        __m128i k512 = distanta(512);
+        for (; p + 64 <= date + lungime; p += 64)
+            for (int i = 0; i < 4; i++)
+                x[i] = pliaza(x[i], k512, incarcaBloc(p + 16 * i, oglindire));
+        acumulator = pliaza(x[0], distanta(384), pliaza(x[1], distanta(256), pliaza(x[2], distanta(128), x[3])));
+    }
+    else {
+        acumulator = _mm_xor_si128(incarcaBloc(p, oglindire), _mm_cvtsi64_si128((long long)stare));
+        p += 16;
+    }
+    __m128i k128 = distanta(128);
+    for (; p + 16 <= date + lungime; p += 16)
+        acumulator = pliaza(acumulator, k128, incarcaBloc(p, oglindire));
+
+    /* T = acumulator * x^64, redus la 128 de biti; apoi T mod P prin Barrett: q = floor(T / P), rest = T - q * P. */
+    __m128i t = _mm_xor_si128(_mm_clmulepi64_si128(acumulator, k128, 0x10), _mm_srli_si128(acumulator, 8));
+    uint64_t t_sus = (uint64_t)_mm_cvtsi128_si64(t);
+    uint64_t t_jos = (uint64_t)_mm_cvtsi128_si64(_mm_srli_si128(t, 8));
+    __m128i produs = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)t_sus), _mm_cvtsi64_si128((long long)c.mu), 0x00);
+    uint64_t q = t_sus ^ ((uint64_t)_mm_cvtsi128_si64(produs) << 1);
+    produs = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)q), _mm_cvtsi64_si128((long long)c.polinom), 0x00);
+    uint64_t produs_jos = (uint64_t)_mm_cvtsi128_si64(produs), produs_sus = (uint64_t)_mm_cvtsi128_si64(_mm_srli_si128(produs, 8));
+    stare = t_jos ^ (produs_sus << 1) ^ (produs_jos >> 63);
+    return (size_t)(p - date);
+}
+#endif
+
+class MotorCRC {
+public:
+    explicit MotorCRC(const ModelCRC& model_dat) : model(model_dat), nume(model_dat.nume ? model_dat.nume : "") {
+        model.nume = nume.c_str();
+        model.polinom &= mascaLatime(model.latime);
+        deplasare = 64 - model.latime;
+        uint64_t polinom64 = model.polinom << deplasare;    /* P * x^(64-w), fara termenul x^64. */
+        polinom_reflectat = reflecta(polinom64, 64);
+        for (int i = 0; i < 256; i++) {
+            uint64_t r = model.reflectat_intrare ? (uint64_t)i : (uint64_t)i << 56;
+            for (int bit = 0; bit < 8; bit++)
+                r = model.reflectat_intrare ? ((r & 1) ? (r >> 1) ^ polinom_reflectat : r >> 1)
+                    : ((r >> 63) ? (r << 1) ^ polinom64 : r << 1);
+            tabel[i] = r;
+        }
+        for (int i = 0; i < 8; i++)
+            constante.k[i] = reflecta(putereXModP(64 * (i + 2) - 1, polinom64), 64);
+        /* mu = floor(x^128 / P): impartire lunga, bitul x^64 al catului este mereu 1. */
+        uint64_t rest = polinom64, cat = 0;
+        for (int i = 63; i >= 0; i--) {
+            uint64_t iesit = rest >> 63;
+            rest <<= 1;
+            if (iesit) {
+                rest ^= polinom64;
+                cat |= 1ull << i;
+            }
+        }
+        constante.mu = reflecta(cat, 64);
+        constante.polinom = polinom_reflectat;
+#if defined(__x86_64__)
+        pliere = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+#endif
+    }
+
+    const ModelCRC& descriere() const { return model; }
+    bool arePliere() const { return pliere; }
+
+    uint64_t stareInitiala() const {
+        uint64_t initial = model.initial & mascaLatime(model.latime);
+        return model.reflectat_intrare ? reflecta(initial, model.latime) : initial << deplasare;
+    }
+
+    uint64_t actualizareTabel(uint64_t stare, const unsigned char* date, size_t lungime) const {
+        if (model.reflectat_intrare)
+            for (size_t i = 0; i < lungime; i++)
+                stare = (stare >> 8) ^ tabel[(stare ^ date[i]) & 0xFF];
+        else
+            for (size_t i = 0; i < lungime; i++)
+                stare = (stare << 8) ^ tabel[(stare >> 56) ^ date[i]];
+        return stare;
+    }
+
+    uint64_t actualizare(uint64_t stare, const unsigned char* date, size_t lungime) const {
+#if defined(__x86_64__)
+        if (pliere && lungime >= PRAG_PLIERE) {
+            /* Registrul nereflectat aliniat la stanga, oglindit pe 64 de biti, este registrul reflectat al aceluiasi polinom. */
+            uint64_t reflectat = model.reflectat_intrare ? stare : reflecta(stare, 64);
+            size_t consumati = actualizarePliere(reflectat, date, lungime, constante, !model.reflectat_intrare);
+            stare = model.reflectat_intrare ? reflectat : reflecta(reflectat, 64);
+            date += consumati;
+            lungime -= consumati;
+        }
+#endif
+        return actualizareTabel(stare, date, lungime);
+    }
+
+    uint64_t finalizare(uint64_t stare) const {
+        /* Registrul in forma normala, ca in calculCRCReferinta. */
+        uint64_t registru = model.reflectat_intrare ? reflecta(stare, model.latime) : stare >> deplasare;
+        if (model.reflectat_iesire)
+            registru = reflecta(registru, model.latime);
+        return (registru ^ model.xor_final) & mascaLatime(model.latime);
+    }
+
+    uint64_t calcul(const unsigned char* date, size_t lungime) const {
+        return finalizare(actualizare(stareInitiala(), date, lungime));
+    }
+
+private:
+    /* x^n mod P, in forma normala (P de grad 64, dat fara termenul x^64). */
+    static uint64_t putereXModP(int n, uint64_t polinom64) {
+        uint64_t r = 1;
+        for (int i = 0; i < n; i++)
+            r = (r >> 63) ? (r << 1) ^ polinom64 : r << 1;
+        return r;
+    }
+
+    ModelCRC model;
+    string nume;
+    int deplasare;
+    uint64_t polinom_reflectat;
+    uint64_t tabel[256];
+    ConstantePliere constante;
+    bool pliere = false;
+};
+
+/* Motoarele modelelor incorporate reflectate, pentru kernel-ul "pliere". Starea lor (registrul reflectat in bitii de jos)
+este chiar starea kernel-urilor cu tabel, deci kernel-urile pot fi amestecate pe bucatile aceluiasi mesaj. */
+uint64_t kernelPliere(AlgoritmCRC algoritm, uint64_t stare, const unsigned char* date, size_t lungime) {
+    static const MotorCRC crc32(modele[algoritm_crc32]), crc16(modele[algoritm_crc16]), crc64(modele[algoritm_crc64]);
+    switch (algoritm) {
+    case algoritm_crc32: return crc32.actualizare(stare, date, lungime);
+    case algoritm_crc16: return crc16.actualizare(stare, date, lungime);
+    case algoritm_crc64: return crc64.actualizare(stare, date, lungime);
+    default: return kernelTabelCRC7((CRC7)stare, date, lungime);
+    }
+}
+
+/* CRC-32/ISO-HDLC pe cea mai rapida cale disponibila, fara metrici, histograme, urma de apeluri sau sonde: plierea PCLMUL
+daca procesorul o are, altfel kernel-ul intercalat sau tabelul. Pentru apelanti care nu trebuie sa scrie in starea comuna
+la fiecare apel (interfata zlib, folosita din oricate fire ale programului gazda). */
+CRC32 actualizareRapidaCRC32(CRC32 rezultat, const unsigned char* date, size_t lungime) {
+    if (lungime >= PRAG_PLIERE && pliereDisponibila(algoritm_crc32))
+        return (CRC32)kernelPliere(algoritm_crc32, rezultat, date, lungime);
+    return lungime >= PRAG_INTERCALARE ? kernelIntercalatCRC32(rezultat, date, lungime) : kernelTabelCRC32(rezultat, date, lungime);
+}
+
+/* Catalogul de modele cunoscute, care pot fi inregistrate dupa nume (parametrii si valorile de verificare dupa catalogul reveng). */
+const ModelCRC catalog_modele[] = {
+    { "CRC-3/ROHC", 3, 0x3, 0x7, true, true, 0x0, 0x6 },
+    { "CRC-5/USB", 5, 0x05, 0x1F, true, true, 0x1F, 0x19 },
+    { "CRC-8/SMBUS", 8, 0x07, 0x00, false, false, 0x00, 0xF4 },
+    { "CRC-8/MAXIM-DOW", 8, 0x31, 0x00, true, true, 0x00, 0xA1 },
+    { "CRC-12/UMTS", 12, 0x80F, 0x000, false, true, 0x000, 0xDAF },
+    { "CRC-16/IBM-3740", 16, 0x1021, 0xFFFF, false, false, 0x0000, 0x29B1 },
+    { "CRC-16/XMODEM", 16, 0x1021, 0x0000, false, false, 0x0000, 0x31C3 },
+    { "CRC-16/KERMIT", 16, 0x1021, 0x0000, true, true, 0x0000, 0x2189 },
+    { "CRC-16/MODBUS", 16, 0x8005, 0xFFFF, true, true, 0x0000, 0x4B37 },
+    { "CRC-24/OPENPGP", 24, 0x864CFB, 0xB704CE, false, false, 0x000000, 0x21CF02 },
+    { "CRC-31/PHILIPS", 31, 0x04C11DB7, 0x7FFFFFFF, false, false, 0x7FFFFFFF, 0x0CE9E46C },
+    { "CRC-32/ISCSI", 32, 0x1EDC6F41, 0xFFFFFFFF, true, true, 0xFFFFFFFF, 0xE3069283 },
+    { "CRC-32/BZIP2", 32, 0x04C11DB7, 0xFFFFFFFF, false, false, 0xFFFFFFFF, 0xFC891918 },
+    { "CRC-32/MPEG-2", 32, 0x04C11DB7, 0xFFFFFFFF, false, false, 0x00000000, 0x0376E6E7 },
+    { "CRC-40/GSM", 40, 0x0004820009ull, 0x0000000000ull, false, false, 0xFFFFFFFFFFull, 0xD4164FC646ull },
+    { "CRC-64/ECMA-182", 64, 0x42F0E1EBA9EA3693ull, 0x0000000000000000ull, false, false, 0x0000000000000000ull, 0x6C40DF5F0B497347ull },
+    { "CRC-64/GO-ISO", 64, 0x000000000000001Bull, 0xFFFFFFFFFFFFFFFFull, true, true, 0xFFFFFFFFFFFFFFFFull, 0xB90956C775A41001ull },
+    { "CRC-64/WE", 64, 0x42F0E1EBA9EA3693ull, 0xFFFFFFFFFFFFFFFFull, false, false, 0xFFFFFFFFFFFFFFFFull, 0x62EC59E3F1A4F00Aull },
+};
+const size_t numar_modele_catalog = sizeof catalog_modele / sizeof catalog_modele[0];
+
+/* Registrul de motoare. Motoarele nu se sterg, deci referintele intoarse raman valide pana la sfarsitul programului. */
+mutex m_motoare;
+vector<unique_ptr<MotorCRC>> motoare_inregistrate;
+
+/* Intoarce motorul deja inregistrat pentru un model cu aceiasi parametri, sau inregistreaza unul nou. */
+const MotorCRC& inregistreazaModel(const ModelCRC& model) {
+    lock_guard<mutex> blocare(m_motoare);
+    for (const unique_ptr<MotorCRC>& motor : motoare_inregistrate) {
+        const ModelCRC& m = motor->descriere();
+        if (m.latime == model.latime && m.polinom == (model.polinom & mascaLatime(model.latime)) && m.initial == model.initial
+            && m.reflectat_intrare == model.reflectat_intrare && m.reflectat_iesire == model.reflectat_iesire && m.xor_final == model.xor_final)
+            return *motor;
+    }
+    motoare_inregistrate.push_back(make_unique<MotorCRC>(model));
+    return *motoare_inregistrate.back();
+}
+
+/* Compara motorul (pliere si tabel) cu implementarea de referinta pe lungimi si alinieri aleatoare si cu valoarea de verificare. */
+int verificareMotor(const MotorCRC& motor, uint64_t samanta, ostream& raport) {
+    const ModelCRC& model = motor.descriere();
+    int nepotriviri = 0;
+    const char* sir_verificare = "123456789";
+    if (model.verificare && motor.calcul((const unsigned char*)sir_verificare, 9) != model.verificare) {
+        raport << model.nume << ": valoare de verificare " << hex << motor.calcul((const unsigned char*)sir_verificare, 9)
+            << ", asteptat " << model.verificare << dec << endl;
+        nepotriviri++;
+    }
+    mt19937_64 generator(samanta);
+    vector<unsigned char> buffer(4096 + 64);
+    for (unsigned char& octet : buffer)
+        octet = (unsigned char)generator();
+    for (int i = 0; i < 200 && nepotriviri < 10; i++) {
+        size_t lungime = i < 100 ? (size_t)i : generator() % 4096;
+        const unsigned char* date = buffer.data() + generator() % 64;
+        uint64_t asteptat = calculCRCReferinta(model, date, lungime);
+        uint64_t pliat = motor.calcul(date, lungime);
+        uint64_t din_tabel = motor.finalizare(motor.actualizareTabel(motor.stareInitiala(), date, lungime));
+        /* Si pe doua bucati, ca starea intermediara sa treaca intre cele doua cai. */
+        size_t taietura = lungime ? generator() % lungime : 0;
+        uint64_t pe_bucati = motor.finalizare(motor.actualizare(motor.actualizare(motor.stareInitiala(), date, taietura), date + taietura, lungime - taietura));
+        if (pliat != asteptat || din_tabel != asteptat || pe_bucati != asteptat) {
+            raport << model.nume << ": lungime " << lungime << ", referinta " << hex << asteptat << ", pliere " << pliat
+                << ", tabel " << din_tabel << ", pe bucati " << pe_bucati << dec << endl;
+            nepotriviri++;
+        }
+    }
+    return nepotriviri;
+}
+
+/* Combinarea a doua coduri CRC (crc32_combine din zlib).
+Cunoscand CRC(A), CRC(B) si lungimea lui B, se poate obtine CRC(A urmat de B) fara a mai parcurge datele:
+CRC(AB) = CRC(A) * x^(8 * lungime(B)) mod P  XOR  CRC(B).
+Formula este exacta pentru CRC16 (valoare initiala 0, fara XOR final) si pentru CRC32, unde valoarea initiala si XOR-ul final
+sunt egale si efectele lor se anuleaza. Asa se pot calcula bucati dintr-un sir lung in paralel, iar rezultatele se lipesc la final. */
+
+/* Inmultirea a doua polinoame modulo P, in reprezentarea reflectata (bitul cel mai semnificativ corespunde lui x^0). */
+template<typename T>
+T inmultireModP(T a, T b, T polinom) {
+    T masca = (T)((T)1 << (sizeof(T) * 8 - 1));
+    T produs = 0;
     for (;;) {
-        cout << "1. Initializare tabele de cautare CRC32, CRC16, CRC7." << endl;
-        cout << "2. Calculare suma de control CRC32 pentru un sir dat de la tastatura." << endl;
-        cout << "3. Calculare suma de control CRC16 pentru un sir dat de la tastatura." << endl;
-        cout << "4. Calculare suma de control CRC7 pentru un sir dat de la tastatura." << endl;
-        cout << endl << "0. Iesire program." << endl;
-        cout << "Dati optiunea: ";
-        cin >> opt;
-        switch ((optiuni)opt)
+        if (a & masca) {
+            produs ^= b;
+            if ((a & (T)(masca - 1)) == 0)
+                break;
+        }
+        masca >>= 1;
+        b = (b & 1) ? (T)((b >> 1) ^ polinom) : (T)(b >> 1);
+    }
+    return produs;
+}
+
+/* x^(8 * n) mod P. Tabelul contine x^(2^k) mod P, obtinut prin ridicari succesive la patrat, si se calculeaza o singura data pentru fiecare polinom. */
+template<typename T, T polinom>
+T putereX8n(uint64_t n) {
+    static const vector<T> puteri = [] {
+        vector<T> tabel(64);
+        tabel[0] = (T)((T)1 << (sizeof(T) * 8 - 2)); /* x^1 */
+        for (int k = 1; k < 64; k++)
+            tabel[k] = inmultireModP<T>(tabel[k - 1], tabel[k - 1], polinom);
+        return tabel;
+    }();
+    T rezultat = (T)((T)1 << (sizeof(T) * 8 - 1)); /* x^0 */
+    for (int k = 3; n; n >>= 1, k++) /* 8 * n = 2^3 * n */
+        if (n & 1)
+            rezultat = inmultireModP<T>(puteri[k], rezultat, polinom);
+    return rezultat;
+}
+
+CRC32 combinaCRC32(CRC32 crc1, CRC32 crc2, uint64_t lungime2) {
+    return inmultireModP<CRC32>(putereX8n<CRC32, polinomCRC32>(lungime2), crc1, polinomCRC32) ^ crc2;
+}
+
+CRC64 combinaCRC64(CRC64 crc1, CRC64 crc2, uint64_t lungime2) {
+    return inmultireModP<CRC64>(putereX8n<CRC64, polinomCRC64>(lungime2), crc1, polinomCRC64) ^ crc2;
+}
+
+CRC16 combinaCRC16(CRC16 crc1, CRC16 crc2, uint64_t lungime2) {
+    return inmultireModP<CRC16>(putereX8n<CRC16, polinomCRC16>(lungime2), crc1, polinomCRC16) ^ crc2;
+}
+
+/* Bazinul de fire de calcul (compute pool).
+Un serviciu asincron nu isi poate bloca bucla de evenimente sute de microsecunde cat timp se parcurge un buffer mare,
+asa ca actualizarile mari sunt trimise unor fire de lucru, iar apelantul este anuntat cand calculul s-a terminat.
+
+Sarcinile au doua clase de prioritate: cele interactive (cereri mici, sensibile la latenta) si cele masive (fisiere de ordinul GB).
+Un fir liber ia intotdeauna intai o sarcina interactiva. Nicio sarcina nu prelucreaza mai mult de FELIE_MASIVA octeti: cererile
+masive sunt impartite in felii, iar cererile interactive mai mari sunt parcurse felie cu felie, fiecare felie urmatoare fiind pusa
+la sfarsitul cozii interactive. O cerere mica asteapta deci cel mult terminarea feliilor aflate deja in lucru (cate una pe fir)
+si a celor cel mult o felie din fata ei din coada interactiva, niciodata a unui fisier sau a unei cereri mari intregi. */
+
+enum ClasaSarcina { sarcina_interactiva, sarcina_masiva, numar_clase_sarcini };
+
+/* Timpul de asteptare in coada, masurat pentru fiecare clasa. */
+struct StatisticiClasa {
+    uint64_t sarcini = 0;
+    double asteptare_totala_us = 0;
+    double asteptare_maxima_us = 0;
+};
+
+class BazinFire {
+public:
+    explicit BazinFire(unsigned numar_fire) {
+        for (unsigned i = 0; i < numar_fire; i++)
+            fire.emplace_back([this] { lucreaza(); });
+    }
+
+    ~BazinFire() {
         {
-        case iesire: cout << "Ati parasit programul."; return 0;
-        case initializare:
-            initializare_tabel32();
-            initializare_tabel16();
-            initializare_tabel7();
-            cout << "Tabelele de cautare CRC32, CRC16, CRC7 au fost initializare." << endl;
-            break;
-        case calcul_CRC32:
-            if (!tabel_CRC32_initializat)
-                cout << "Se recomanda initializarea tabelului de cautare CRC32 intai." << endl;
-            else {
-                cout << "Dati sirul de intrare: "; cin.get();
-                getline(cin, sir_intrare);
-                cout << "Cod CRC32 obtinut pentru sirul de intrare " << sir_intrare << ": " << hex << calculCRC32(sir_intrare) << endl;
-            }
-            break;
-        case calcul_CRC16:
-            if (!tabel_CRC16_initializat)
-                cout << "Se recomanda initializarea tabelului de cautare CRC16 intai." << endl;
-            else {
-                cout << "Dati sirul de intrare: "; cin.get();
-                getline(cin, sir_intrare);
-                cout << "Cod CRC16 obtinut pentru sirul de intrare " << sir_intrare << ": " << hex << calculCRC16(sir_intrare) << endl;
-            }
-            break;
-        case calcul_CRC7:
-            if (!tabel_CRC7_initializat)
-                cout << "Se recomanda initializarea tabelului de cautare CRC7 intai." << endl;
-            else {
-                cout << "Dati sirul de intrare: "; cin.get();
-                getline(cin, sir_intrare);
-                cout << "Cod CRC7 obtinut pentru sirul de intrare " << sir_intrare << ": " << hex << (unsigned)calculCRC7(sir_intrare) << endl;
+            lock_guard<mutex> blocare(m);
+            oprire = true;
+        }
+        cv.notify_all();
+        for (thread& fir : fire)
+            fir.join();
+    }
+
+    void adauga(function<void()> sarcina, ClasaSarcina clasa = sarcina_interactiva) {
+        {
+            lock_guard<mutex> blocare(m);
+            sarcini[clasa].push({ move(sarcina), chrono::steady_clock::now() });
+            SONDA2(batch_dispatch, (int)clasa, sarcini[clasa].size());
+        }
+        cv.notify_one();
+    }
+
+    StatisticiClasa statistici(ClasaSarcina clasa) {
+        lock_guard<mutex> blocare(m);
+        return statistici_clase[clasa];
+    }
+
+    size_t lungimeCoada(ClasaSarcina clasa) {
+        lock_guard<mutex> blocare(m);
+        return sarcini[clasa].size();
+    }
+
+private:
+    struct SarcinaInCoada {
+        function<void()> functie;
+        chrono::steady_clock::time_point adaugata;
+    };
+
+    void lucreaza() {
+        for (;;) {
+            function<void()> sarcina;
+            {
+                unique_lock<mutex> blocare(m);
+                cv.wait(blocare, [this] { return oprire || !sarcini[sarcina_interactiva].empty() || !sarcini[sarcina_masiva].empty(); });
+                int clasa = !sarcini[sarcina_interactiva].empty() ? sarcina_interactiva : sarcina_masiva;
+                if (sarcini[clasa].empty()) /* Se opreste doar dupa ce a terminat tot ce era in cozi. */
+                    return;
+                SarcinaInCoada& urmatoarea = sarcini[clasa].front();
+                double asteptare = chrono::duration<double, micro>(chrono::steady_clock::now() - urmatoarea.adaugata).count();
+                StatisticiClasa& s = statistici_clase[clasa];
+                s.sarcini++;
+                s.asteptare_totala_us += asteptare;
+                s.asteptare_maxima_us = max(s.asteptare_maxima_us, asteptare);
+                sarcina = move(urmatoarea.functie);
+                sarcini[clasa].pop();
             }
-                break;
-        default: cout << "Optiune incorecta." << endl; break;
+            sarcina();
         }
     }
-}
\ No newline at end of file
+
+    vector<thread> fire;
+    queue<SarcinaInCoada> sarcini[numar_clase_sarcini];
+    StatisticiClasa statistici_clase[numar_clase_sarcini];
+    mutex m;
+    condition_variable cv;
+    bool oprire = false;
+};
+
+atomic<BazinFire*> bazin_creat{ nullptr };
+
+BazinFire& bazinCalcul() {
+    static BazinFire bazin(max(1u, thread::hardware_concurrency()));
+    static bool publicat = (bazin_creat.store(&bazin, memory_order_release), true);
+    (void)publicat;
+    return bazin;
+}
+
+/* Bazinul, doar daca a fost deja creat; pentru cititorii (ex.: metricile) care nu trebuie sa porneasca firele. */
+BazinFire* bazinExistent() {
+    return bazin_creat.load(memory_order_acquire);
+}
+
+#define FELIE_MASIVA (256 * 1024) /* Dimensiunea maxima a unei felii dintr-o sarcina masiva. */
+
+/* Calcul CRC32 pentru un buffer mare, ca sarcina masiva: fiecare felie primeste CRC-ul ei pe un fir din bazin,
+iar cand s-a terminat ultima felie, codurile sunt combinate in ordine si se apeleaza la_final cu rezultatul. */
+void calculCRC32Masiv(const unsigned char* date, size_t lungime, function<void(CRC32)> la_final) {
+    struct Lucrare {
+        vector<CRC32> coduri;
+        size_t ramase;
+        mutex m;
+    };
+    size_t numar_felii = max<size_t>(1, (lungime + FELIE_MASIVA - 1) / FELIE_MASIVA);
+    SONDA2(bulk_split, lungime, numar_felii);
+    shared_ptr<Lucrare> lucrare = make_shared<Lucrare>();
+    lucrare->coduri.resize(numar_felii);
+    lucrare->ramase = numar_felii;
+
+    for (size_t i = 0; i < numar_felii; i++) {
+        bazinCalcul().adauga([=] {
+            size_t inceput = i * FELIE_MASIVA;
+            size_t bucata = min<size_t>(FELIE_MASIVA, lungime - inceput);
+            lucrare->coduri[i] = actualizareCRC32(0xFFFFFFFF, date + inceput, bucata) ^ 0xFFFFFFFF;
+            {
+                lock_guard<mutex> blocare(lucrare->m);
+                if (--lucrare->ramase)
+                    return;
+            }
+            CRC32 rezultat = lucrare->coduri[0];
+            for (size_t j = 1; j < numar_felii; j++)
+                rezultat = combinaCRC32(rezultat, lucrare->coduri[j], min<size_t>(FELIE_MASIVA, lungime - j * FELIE_MASIVA));
+            la_final(rezultat);
+        }, sarcina_masiva);
+    }
+}
+
+/* Sub acest prag (in octeti) actualizarea se face direct pe firul apelantului: trecerea pe alt fir ar costa mai mult decat calculul. */
+#define PRAG_ASYNC (64 * 1024)
+/* De la acest prag in sus o actualizare este tratata ca sarcina masiva si impartita in felii. */
+#define PRAG_MASIV (1024 * 1024)
+
+#if defined(__cpp_impl_coroutine)
+/* Obiect "awaitable" pentru C++20: co_await flux.actualizare_coroutina(date, lungime).
+Daca se da functia "reluare", corutina este repusa in bucla de evenimente a apelantului (ex.: un post() pe bucla epoll/io_uring);
+altfel ea este reluata direct pe firul de calcul. */
+template<typename Flux>
+struct AsteptareCRC {
+    Flux* flux;
+    const unsigned char* date;
+    size_t lungime;
+    function<void(coroutine_handle<>)> reluare;
+
+    bool await_ready() {
+        if (lungime >= PRAG_ASYNC)
+            return false;
+        flux->actualizare(date, lungime);
+        return true;
+    }
+
+    /* Dupa reluarea corutinei acest obiect (din cadrul corutinei) nu mai exista, iar reluarea poate incepe chiar inainte ca
+    functia de final sa se termine, asa ca ea lucreaza doar cu copii, fara "this". */
+    void await_suspend(coroutine_handle<> corutina) {
+        flux->actualizare_async(date, lungime, [reluare = move(reluare), corutina] {
+            if (reluare)
+                reluare(corutina);
+            else
+                corutina.resume();
+        });
+    }
+
+    void await_resume() {}
+};
+#endif
+
+/* Calcul CRC32 pe bucati. Starea se pastreaza intre apeluri, iar valoarea finala se obtine cu valoare().
+Pentru un acelasi flux, o actualizare asincrona trebuie asteptata inainte de a incepe urmatoarea, deoarece CRC-ul depinde de ordinea octetilor.
+Bufferul dat unei actualizari asincrone trebuie sa ramana valid pana la terminarea ei. */
+class FluxCRC32 {
+public:
+    void actualizare(const void* date, size_t lungime) {
+        rezultat = actualizareCRC32(rezultat, (const unsigned char*)date, lungime);
+    }
+
+    void actualizare(const string& buffer) { actualizare(buffer.data(), buffer.length()); }
+
+    /* Varianta cu functie apelata la final (callback). */
+    void actualizare_async(const void* date, size_t lungime, function<void()> la_final) {
+        if (lungime < PRAG_ASYNC) {
+            actualizare(date, lungime);
+            la_final();
+            return;
+        }
+        if (lungime < PRAG_MASIV) {
+            actualizareInteractiva((const unsigned char*)date, lungime, move(la_final));
+            return;
+        }
+        calculCRC32Masiv((const unsigned char*)date, lungime, [this, lungime, la_final](CRC32 crc) {
+            rezultat = combinaCRC32(valoare(), crc, lungime) ^ 0xFFFFFFFF;
+            la_final();
+        });
+    }
+
+    /* Varianta cu future, pentru apelantii care nu au o bucla de evenimente. */
+    future<void> actualizare_async(const void* date, size_t lungime) {
+        shared_ptr<promise<void>> gata = make_shared<promise<void>>();
+        future<void> rezultat_viitor = gata->get_future();
+        actualizare_async(date, lungime, [gata] { gata->set_value(); });
+        return rezultat_viitor;
+    }
+
+    future<void> actualizare_async(const string& buffer) { return actualizare_async(buffer.data(), buffer.length()); }
+
+#if defined(__cpp_impl_coroutine)
+    AsteptareCRC<FluxCRC32> actualizare_coroutina(const void* date, size_t lungime, function<void(coroutine_handle<>)> reluare = nullptr) {
+        return AsteptareCRC<FluxCRC32>{ this, (const unsigned char*)date, lungime, move(reluare) };
+    }
+#endif
+
+    CRC32 valoare() const { return rezultat ^ 0xFFFFFFFF; }
+
+private:
+    /* O felie pe sarcina; felia urmatoare se pune in coada abia dupa ce s-a terminat cea curenta, deci ordinea se pastreaza
+    iar alte cereri interactive pot trece intre felii. */
+    void actualizareInteractiva(const unsigned char* date, size_t lungime, function<void()> la_final) {
+        bazinCalcul().adauga([this, date, lungime, la_final = move(la_final)] {
+            size_t bucata = min<size_t>(lungime, FELIE_MASIVA);
+            actualizare(date, bucata);
+            if (bucata == lungime)
+                la_final();
+            else
+                actualizareInteractiva(date + bucata, lungime - bucata, la_final);
+        }, sarcina_interactiva);
+    }
+
+    CRC32 rezultat = 0xFFFFFFFF;
+};
+
+/* Citeste tot continutul unui fisier intr-un string. Intoarce false daca fisierul nu poate fi deschis. */
+bool citireFisier(const string& cale, string& continut) {
+    ifstream fisier(cale, ios::binary);
+    if (!fisier)
+        return false;
+    ostringstream flux;
+    flux << fisier.rdbuf();
+    continut = flux.str();
+    return true;
+}
+
+/* Conducta pentru fisiere si directoare (read -> CRC -> output), cu memorie limitata.
+Un fir citeste blocuri din fisiere, mai multe fire calculeaza CRC32 pentru fiecare bloc, iar firul apelant combina codurile
+blocurilor in ordine si afiseaza rezultatul pentru fiecare fisier.
+Toate blocurile citite vin dintr-un bazin cu un numar fix de buffere (buget / dimensiune bloc). Cand bazinul este gol, cititorul
+asteapta pana cand firele de calcul elibereaza un buffer, deci citirea nu poate lua un avans mai mare decat bugetul de memorie. */
+
+/* Coada cu capacitate fixa intre doua etape. pune() blocheaza cat timp coada este plina. */
+template<typename T>
+class CoadaMarginita {
+public:
+    /* Daca se da un indicator (gauge), adancimea cozii este publicata in metrici la fiecare modificare. */
+    explicit CoadaMarginita(size_t capacitate, atomic<int64_t>* adancime = nullptr) : capacitate(capacitate), adancime(adancime) {}
+
+    void pune(T element) {
+        unique_lock<mutex> blocare(m);
+        cv_loc.wait(blocare, [this] { return elemente.size() < capacitate; });
+        elemente.push(move(element));
+        if (adancime)
+            adancime->store((int64_t)elemente.size(), memory_order_relaxed);
+        cv_element.notify_one();
+    }
+
+    /* Intoarce false cand coada a fost inchisa si nu mai are elemente. */
+    bool scoate(T& element) {
+        unique_lock<mutex> blocare(m);
+        cv_element.wait(blocare, [this] { return inchisa || !elemente.empty(); });
+        if (elemente.empty())
+            return false;
+        element = move(elemente.front());
+        elemente.pop();
+        if (adancime)
+            adancime->store((int64_t)elemente.size(), memory_order_relaxed);
+        cv_loc.notify_one();
+        return true;
+    }
+
+    void inchide() {
+        lock_guard<mutex> blocare(m);
+        inchisa = true;
+        cv_element.notify_all();
+    }
+
+    size_t dimensiune() {
+        lock_guard<mutex> blocare(m);
+        return elemente.size();
+    }
+
+private:
+    size_t capacitate;
+    atomic<int64_t>* adancime;
+    queue<T> elemente;
+    mutex m;
+    condition_variable cv_loc, cv_element;
+    bool inchisa = false;
+};
+
+/* Bazin de buffere alocate o singura data, la pornire. */
+class BazinBuffere {
+public:
+    BazinBuffere(size_t dimensiune_bloc, size_t numar_buffere) : libere(numar_buffere) {
+        buffere.resize(numar_buffere);
+        for (vector<unsigned char>& buffer : buffere) {
+            buffer.resize(dimensiune_bloc);
+            libere.pune(&buffer);
+        }
+    }
+
+    vector<unsigned char>* ia() {
+        vector<unsigned char>* buffer = nullptr;
+        libere.scoate(buffer);
+        return buffer;
+    }
+
+    void elibereaza(vector<unsigned char>* buffer) { libere.pune(buffer); }
+
+private:
+    vector<vector<unsigned char>> buffere;
+    CoadaMarginita<vector<unsigned char>*> libere;
+};
+
+/* Varful memoriei rezidente a procesului (peak RSS), in octeti. Intoarce 0 daca sistemul nu ofera aceasta informatie. */
+uint64_t varfMemorieRezidenta() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS contoare;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &contoare, sizeof(contoare)))
+        return contoare.PeakWorkingSetSize;
+    return 0;
+#elif defined(__unix__) || defined(__APPLE__)
+    struct rusage utilizare;
+    if (getrusage(RUSAGE_SELF, &utilizare) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return (uint64_t)utilizare.ru_maxrss; /* Pe macOS valoarea este deja in octeti. */
+#else
+    return (uint64_t)utilizare.ru_maxrss * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+/* Apeleaza functia data pentru "cale", daca este un fisier, sau pentru fiecare fisier obisnuit din director si subdirectoare. */
+void parcurgeFisiere(const string& cale, const function<void(const string&)>& functie) {
+    error_code eroare;
+    if (!filesystem::is_directory(cale, eroare)) {
+        functie(cale);
+        return;
+    }
+    filesystem::recursive_directory_iterator it(cale, filesystem::directory_options::skip_permission_denied, eroare), sfarsit;
+    for (; !eroare && it != sfarsit; it.increment(eroare))
+        if (it->is_regular_file(eroare))
+            functie(it->path().string());
+}
+
+/* Cronologia evenimentelor din conducta, exportata ca JSON "Chrome trace" (se deschide in Perfetto sau chrome://tracing).
+Fiecare fir scrie intervale (nume, inceput, durata, fisier, bloc, octeti) intr-un inel propriu, fara blocari: doar firul
+proprietar scrie in inel, iar indexul de scriere este publicat cu memory_order_release. Cand inelul se umple, evenimentele
+cele mai vechi sunt suprascrise si numarate ca pierdute. Inelele se aloca la primul eveniment al fiecarui fir.
+Pornirea (care sterge inelele vechi) si exportul trebuie facute cand nicio rulare trasata nu este in curs.
+Cand cronologia este oprita, un interval costa o singura citire atomica. */
+
+#define CAPACITATE_INEL_CRONOLOGIE (1 << 16)
+
+struct EvenimentCronologie {
+    const char* nume;       /* Sir literal. */
+    uint64_t inceput_ns;    /* De la pornirea cronologiei. */
+    uint64_t durata_ns;
+    uint64_t fisier, bloc, octeti;
+};
+
+const uint64_t FARA_ARGUMENT = UINT64_MAX;
+
+struct InelCronologie {
+    explicit InelCronologie(uint64_t id, string nume) : id(id), nume(move(nume)), evenimente(CAPACITATE_INEL_CRONOLOGIE) {}
+
+    void adauga(const EvenimentCronologie& eveniment) {
+        uint64_t i = scrise.load(memory_order_relaxed);
+        evenimente[i % CAPACITATE_INEL_CRONOLOGIE] = eveniment;
+        scrise.store(i + 1, memory_order_release);
+    }
+
+    uint64_t id;
+    string nume;
+    vector<EvenimentCronologie> evenimente;
+    atomic<uint64_t> scrise{ 0 };
+};
+
+struct Cronologie {
+    atomic<bool> activa{ false };
+    atomic<uint64_t> generatie{ 0 };    /* Schimbata la fiecare pornire, ca firele sa nu mai foloseasca inelele sterse. */
+    chrono::steady_clock::time_point inceput;
+    mutex m;
+    vector<unique_ptr<InelCronologie>> inele;
+} cronologie;
+
+thread_local string nume_fir_cronologie;
+
+/* Inelul firului curent pentru pornirea curenta a cronologiei. */
+InelCronologie& inelFir() {
+    thread_local InelCronologie* inel = nullptr;
+    thread_local uint64_t generatie = 0;
+    uint64_t actuala = cronologie.generatie.load(memory_order_acquire);
+    if (!inel || generatie != actuala) {
+        lock_guard<mutex> blocare(cronologie.m);
+        uint64_t id = cronologie.inele.size() + 1;
+        cronologie.inele.push_back(make_unique<InelCronologie>(id, nume_fir_cronologie.empty() ? "fir " + to_string(id) : nume_fir_cronologie));
+        inel = cronologie.inele.back().get();
+        generatie = actuala;
+    }
+    return *inel;
+}
+
+/* Numele firului in cronologie (de exemplu "cititor"); se pastreaza pentru inelele create ulterior de acelasi fir. */
+void numeFirCronologie(const string& nume) {
+    nume_fir_cronologie = nume;
+}
+
+/* Un interval de timp inregistrat de la constructie pana la distrugere. */
+class IntervalCronologie {
+public:
+    explicit IntervalCronologie(const char* nume, uint64_t fisier = FARA_ARGUMENT, uint64_t bloc = FARA_ARGUMENT, uint64_t octeti = FARA_ARGUMENT)
+        : eveniment{ nume, 0, 0, fisier, bloc, octeti }, activ(cronologie.activa.load(memory_order_relaxed)) {
+        if (activ)
+            inceput = chrono::steady_clock::now();
+    }
+    ~IntervalCronologie() {
+        if (!activ)
+            return;
+        auto sfarsit = chrono::steady_clock::now();
+        eveniment.inceput_ns = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(inceput - cronologie.inceput).count();
+        eveniment.durata_ns = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(sfarsit - inceput).count();
+        inelFir().adauga(eveniment);
+    }
+    /* Pentru argumentele aflate abia dupa inceputul intervalului (de exemplu octetii cititi). */
+    void octeti(uint64_t n) { eveniment.octeti = n; }
+
+    IntervalCronologie(const IntervalCronologie&) = delete;
+    IntervalCronologie& operator=(const IntervalCronologie&) = delete;
+
+private:
+    EvenimentCronologie eveniment;
+    bool activ;
+    chrono::steady_clock::time_point inceput;
+};
+
+void pornesteCronologie() {
+    lock_guard<mutex> blocare(cronologie.m);
+    cronologie.inele.clear();
+    cronologie.inceput = chrono::steady_clock::now();
+    cronologie.generatie.fetch_add(1, memory_order_release);
+    cronologie.activa.store(true);
+}
+
+void opresteCronologie() {
+    cronologie.activa.store(false);
+}
+
+/* Scrie toate evenimentele pastrate in format JSON "Chrome trace" (evenimente complete "X", timpi in microsecunde). */
+void exportaCronologie(ostream& iesire, uint64_t& exportate, uint64_t& pierdute) {
+    lock_guard<mutex> blocare(cronologie.m);
+    exportate = pierdute = 0;
+    char linie[320];
+    iesire << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool primul = true;
+    for (const unique_ptr<InelCronologie>& inel : cronologie.inele) {
+        /* Numele firelor sunt alese in program si nu contin caractere care trebuie escapate in JSON. */
+        iesire << (primul ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << inel->id
+            << ",\"args\":{\"name\":\"" << inel->nume << "\"}}";
+        primul = false;
+        uint64_t scrise = inel->scrise.load(memory_order_acquire);
+        uint64_t pastrate = min<uint64_t>(scrise, CAPACITATE_INEL_CRONOLOGIE);
+        pierdute += scrise - pastrate;
+        for (uint64_t i = scrise - pastrate; i < scrise; i++) {
+            const EvenimentCronologie& e = inel->evenimente[i % CAPACITATE_INEL_CRONOLOGIE];
+            int n = snprintf(linie, sizeof linie, ",\n{\"name\":\"%s\",\"cat\":\"conducta\",\"ph\":\"X\",\"pid\":1,\"tid\":%llu,\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+                e.nume, (unsigned long long)inel->id, e.inceput_ns / 1000.0, e.durata_ns / 1000.0);
+            const char* separator = "";
+            for (const auto& [nume, valoare] : { make_pair("fisier", e.fisier), make_pair("bloc", e.bloc), make_pair("octeti", e.octeti) })
+                if (valoare != FARA_ARGUMENT) {
+                    n += snprintf(linie + n, sizeof linie - n, "%s\"%s\":%llu", separator, nume, (unsigned long long)valoare);
+                    separator = ",";
+                }
+            snprintf(linie + n, sizeof linie - n, "}}");
+            iesire << linie;
+            exportate++;
+        }
+    }
+    iesire << "\n],\"otherData\":{\"evenimente_pierdute\":" << pierdute << "}}\n";
+}
+
+struct OptiuniConducta {
+    size_t dimensiune_bloc = 1024 * 1024;
+    size_t buget_memorie = 64 * 1024 * 1024;
+    unsigned fire_calcul = max(1u, thread::hardware_concurrency());
+};
+
+struct RezumatConducta {
+    uint64_t fisiere = 0;
+    uint64_t octeti = 0;
+    uint64_t erori = 0;
+    double secunde = 0;
+};
+
+class ConductaCRC {
+public:
+    explicit ConductaCRC(const OptiuniConducta& optiuni) : optiuni(optiuni) {}
+
+    /* Calculeaza CRC32 pentru un fisier sau pentru toate fisierele dintr-un director (recursiv).
+    Pentru fiecare fisier se scrie o linie "crc  cale" in iesire, in ordinea in care fisierele au fost gasite. */
+    RezumatConducta ruleaza(const string& cale, ostream& iesire) {
+        size_t numar_buffere = max<size_t>(2, optiuni.buget_memorie / optiuni.dimensiune_bloc);
+        BazinBuffere bazin(optiuni.dimensiune_bloc, numar_buffere);
+        CoadaMarginita<Bloc> blocuri(numar_buffere, &metrici.coada_blocuri);
+        CoadaMarginita<Bloc> rezultate(numar_buffere, &metrici.coada_rezultate);
+        RezumatConducta rezumat;
+        auto inceput = chrono::steady_clock::now();
+
+        thread cititor([&] {
+            numeFirCronologie("cititor");
+            citeste(cale, bazin, blocuri);
+            blocuri.inchide();
+        });
+        vector<thread> calcul;
+        for (unsigned i = 0; i < optiuni.fire_calcul; i++)
+            calcul.emplace_back([&, i] {
+                numeFirCronologie("calcul " + to_string(i));
+                Bloc bloc;
+                for (;;) {
+                    {
+                        IntervalCronologie asteptare("asteptare bloc");
+                        if (!blocuri.scoate(bloc))
+                            break;
+                    }
+                    if (bloc.buffer) {
+                        IntervalCronologie interval("crc", bloc.fisier, bloc.index, bloc.lungime);
+                        auto inceput_calcul = chrono::steady_clock::now();
+                        bloc.crc = actualizareCRC32(0xFFFFFFFF, bloc.buffer->data(), bloc.lungime) ^ 0xFFFFFFFF;
+                        metrici.timp_calcul_ns.fetch_add(nanosecundeDeLa(inceput_calcul), memory_order_relaxed);
+                        bazin.elibereaza(bloc.buffer);
+                        bloc.buffer = nullptr;
+                    }
+                    IntervalCronologie punere("punere rezultat", bloc.fisier, bloc.index);
+                    rezultate.pune(move(bloc));
+                }
+            });
+        thread inchidere([&] {
+            for (thread& fir : calcul)
+                fir.join();
+            rezultate.inchide();
+        });
+
+        numeFirCronologie("iesire");
+        scrie(rezultate, iesire, rezumat);
+        cititor.join();
+        inchidere.join();
+        rezumat.secunde = chrono::duration<double>(chrono::steady_clock::now() - inceput).count();
+        return rezumat;
+    }
+
+private:
+    struct Bloc {
+        uint64_t fisier = 0;
+        uint64_t index = 0;
+        shared_ptr<const string> cale;
+        vector<unsigned char>* buffer = nullptr;
+        size_t lungime = 0;
+        bool ultimul = false;
+        bool eroare = false;
+        CRC32 crc = 0;
+    };
+
+    void citeste(const string& cale, BazinBuffere& bazin, CoadaMarginita<Bloc>& blocuri) {
+        uint64_t fisier = 0;
+        parcurgeFisiere(cale, [&](const string& nume) { citesteFisier(fisier++, nume, bazin, blocuri); });
+    }
+
+    void citesteFisier(uint64_t fisier, const string& cale, BazinBuffere& bazin, CoadaMarginita<Bloc>& blocuri) {
+        shared_ptr<const string> nume = make_shared<const string>(cale);
+        ifstream intrare;
+        {
+            IntervalCronologie deschidere("deschidere", fisier);
+            intrare.open(cale, ios::binary);
+        }
+        if (!intrare) {
+            Bloc bloc;
+            bloc.fisier = fisier;
+            bloc.cale = nume;
+            bloc.ultimul = bloc.eroare = true;
+            blocuri.pune(move(bloc));
+            return;
+        }
+        for (uint64_t index = 0;; index++) {
+            Bloc bloc;
+            bloc.fisier = fisier;
+            bloc.index = index;
+            bloc.cale = nume;
+            {
+                IntervalCronologie asteptare("asteptare buffer", fisier, index);
+                bloc.buffer = bazin.ia(); /* Aici cititorul asteapta daca tot bugetul de memorie este in lucru. */
+            }
+            {
+                IntervalCronologie citire("citire", fisier, index);
+                auto inceput_citire = chrono::steady_clock::now();
+                intrare.read((char*)bloc.buffer->data(), bloc.buffer->size());
+                metrici.timp_citire_ns.fetch_add(nanosecundeDeLa(inceput_citire), memory_order_relaxed);
+                bloc.lungime = (size_t)intrare.gcount();
+                citire.octeti(bloc.lungime);
+            }
+            bloc.eroare = intrare.bad();
+            bool ultimul = bloc.ultimul = intrare.peek() == char_traits<char>::eof(); /* peek() intoarce eof si dupa o citire esuata. */
+            IntervalCronologie punere("punere bloc", fisier, index);
+            blocuri.pune(move(bloc));
+            if (ultimul)
+                return;
+        }
+    }
+
+    /* Etapa de iesire: blocurile unui fisier pot sosi in orice ordine, asa ca se pastreaza pana cand pot fi combinate in ordine. */
+    void scrie(CoadaMarginita<Bloc>& rezultate, ostream& iesire, RezumatConducta& rezumat) {
+        struct StareFisier {
+            shared_ptr<const string> cale;
+            map<uint64_t, pair<CRC32, size_t>> in_asteptare;
+            uint64_t urmatorul = 0;
+            uint64_t total = UINT64_MAX;
+            CRC32 crc = 0;
+            uint64_t octeti = 0;
+            bool eroare = false;
+        };
+        map<uint64_t, StareFisier> fisiere;
+        uint64_t de_scris = 0;
+        Bloc bloc;
+        for (;;) {
+            {
+                IntervalCronologie asteptare("asteptare rezultat");
+                if (!rezultate.scoate(bloc))
+                    break;
+            }
+            IntervalCronologie combinare("combinare si scriere", bloc.fisier, bloc.index);
+            StareFisier& stare = fisiere[bloc.fisier];
+            stare.cale = bloc.cale;
+            stare.eroare |= bloc.eroare;
+            if (bloc.ultimul)
+                stare.total = bloc.index + 1;
+            stare.in_asteptare[bloc.index] = { bloc.crc, bloc.lungime };
+            while (!stare.in_asteptare.empty() && stare.in_asteptare.begin()->first == stare.urmatorul) {
+                pair<CRC32, size_t> cod = stare.in_asteptare.begin()->second;
+                stare.crc = stare.urmatorul ? combinaCRC32(stare.crc, cod.first, cod.second) : cod.first;
+                stare.octeti += cod.second;
+                stare.in_asteptare.erase(stare.in_asteptare.begin());
+                stare.urmatorul++;
+            }
+            /* Fisierele terminate se scriu in ordinea in care au fost gasite. */
+            while (!fisiere.empty() && fisiere.begin()->first == de_scris && fisiere.begin()->second.urmatorul == fisiere.begin()->second.total) {
+                StareFisier& gata = fisiere.begin()->second;
+                if (gata.eroare) {
+                    iesire << "EROARE  " << *gata.cale << endl;
+                    rezumat.erori++;
+                    metrici.erori_citire.fetch_add(1, memory_order_relaxed);
+                }
+                else {
+                    char cod[9];
+                    snprintf(cod, sizeof(cod), "%08x", (unsigned)gata.crc);
+                    iesire << cod << "  " << *gata.cale << "\n";
+                    SONDA3(file_done, gata.cale->c_str(), gata.octeti, (unsigned)gata.crc);
+                    rezumat.fisiere++;
+                    rezumat.octeti += gata.octeti;
+                    metrici.fisiere.fetch_add(1, memory_order_relaxed);
+                }
+                fisiere.erase(fisiere.begin());
+                de_scris++;
+            }
+        }
+        iesire.flush();
+    }
+
+    OptiuniConducta optiuni;
+};
+
+/* Exportul metricilor in formatul text Prometheus (version 0.0.4). */
+void scrieMetriciPrometheus(ostream& iesire) {
+    iesire << "# HELP checksum_bytes_total Octeti prelucrati, pe algoritm.\n";
+    iesire << "# TYPE checksum_bytes_total counter\n";
+    for (int algoritm = 0; algoritm < numar_algoritmi; algoritm++)
+        iesire << "checksum_bytes_total{algorithm=\"" << nume_algoritmi[algoritm] << "\"} " << metrici.octeti[algoritm].load(memory_order_relaxed) << "\n";
+
+    iesire << "# HELP checksum_kernel_selections_total De cate ori a fost ales fiecare kernel.\n";
+    iesire << "# TYPE checksum_kernel_selections_total counter\n";
+    for (int algoritm = 0; algoritm < numar_algoritmi; algoritm++)
+        for (int kernel = 0; kernel < numar_kerneluri; kernel++)
+            iesire << "checksum_kernel_selections_total{algorithm=\"" << nume_algoritmi[algoritm] << "\",kernel=\"" << nume_kerneluri[kernel] << "\"} "
+                << metrici.selectii_kernel[algoritm][kernel].load(memory_order_relaxed) << "\n";
+
+    iesire << "# HELP checksum_mismatches_total Coduri CRC sau lungimi ISIZE gzip diferite de cele asteptate.\n";
+    iesire << "# TYPE checksum_mismatches_total counter\n";
+    iesire << "checksum_mismatches_total " << metrici.nepotriviri.load(memory_order_relaxed) << "\n";
+
+    iesire << "# HELP checksum_files_total Fisiere prelucrate de conducta.\n";
+    iesire << "# TYPE checksum_files_total counter\n";
+    iesire << "checksum_files_total " << metrici.fisiere.load(memory_order_relaxed) << "\n";
+
+    iesire << "# HELP checksum_read_errors_total Fisiere care nu au putut fi citite.\n";
+    iesire << "# TYPE checksum_read_errors_total counter\n";
+    iesire << "checksum_read_errors_total " << metrici.erori_citire.load(memory_order_relaxed) << "\n";
+
+    iesire << "# HELP checksum_io_seconds_total Timp petrecut in citiri.\n";
+    iesire << "# TYPE checksum_io_seconds_total counter\n";
+    iesire << "checksum_io_seconds_total " << metrici.timp_citire_ns.load(memory_order_relaxed) / 1e9 << "\n";
+
+    iesire << "# HELP checksum_compute_seconds_total Timp petrecut in calculul CRC.\n";
+    iesire << "# TYPE checksum_compute_seconds_total counter\n";
+    iesire << "checksum_compute_seconds_total " << metrici.timp_calcul_ns.load(memory_order_relaxed) / 1e9 << "\n";
+
+    iesire << "# HELP checksum_queue_depth Numarul de elemente din fiecare coada.\n";
+    iesire << "# TYPE checksum_queue_depth gauge\n";
+    BazinFire* bazin = bazinExistent();
+    iesire << "checksum_queue_depth{queue=\"interactive\"} " << (bazin ? bazin->lungimeCoada(sarcina_interactiva) : 0) << "\n";
+    iesire << "checksum_queue_depth{queue=\"bulk\"} " << (bazin ? bazin->lungimeCoada(sarcina_masiva) : 0) << "\n";
+    iesire << "checksum_queue_depth{queue=\"pipeline_read\"} " << metrici.coada_blocuri.load(memory_order_relaxed) << "\n";
+    iesire << "checksum_queue_depth{queue=\"pipeline_output\"} " << metrici.coada_rezultate.load(memory_order_relaxed) << "\n";
+}
+
+/* Scrie metricile intr-un fisier (ex.: pentru colectorul "textfile" din node_exporter).
+Se scrie intai un fisier temporar care apoi este redenumit, ca cititorul sa nu vada niciodata un fisier scris pe jumatate. */
+bool exportMetriciFisier(const string& cale) {
+    string temporar = cale + ".tmp";
+    {
+        ofstream fisier(temporar);
+        if (!fisier)
+            return false;
+        scrieMetriciPrometheus(fisier);
+        if (!fisier)
+            return false;
+    }
+    error_code eroare;
+    filesystem::rename(temporar, cale, eroare);
+    return !eroare;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+/* Server HTTP minimal pe un socket Unix, care raspunde la orice cerere cu metricile curente.
+Se poate citi cu: curl --unix-socket <cale> http://localhost/metrics
+Exista cel mult un server; el se opreste cu opreste() (sau la iesirea din program) si isi sterge socket-ul. Un socket existent
+la aceeasi cale este inlocuit doar daca nu mai asculta nimeni pe el (ramas de la un proces oprit). Fiecare client are o limita
+de timp pentru citirea cererii si trimiterea raspunsului, ca un client inactiv sa nu blocheze serverul. */
+class ServerMetrici {
+public:
+    ~ServerMetrici() { opreste(); }
+
+    /* Intoarce false, cu motivul in "eroare", daca serverul nu poate fi pornit. */
+    bool porneste(const string& cale, string& eroare) {
+        lock_guard<mutex> blocare(m);
+        if (fir.joinable()) {
+            eroare = "serverul ruleaza deja pe " + cale_socket;
+            return false;
+        }
+        sockaddr_un adresa = {};
+        if (cale.size() >= sizeof(adresa.sun_path)) {
+            eroare = "calea este prea lunga";
+            return false;
+        }
+        adresa.sun_family = AF_UNIX;
+        memcpy(adresa.sun_path, cale.c_str(), cale.size() + 1);
+        struct stat informatii;
+        if (lstat(cale.c_str(), &informatii) == 0) {
+            if (!S_ISSOCK(informatii.st_mode)) {
+                eroare = "exista deja un fisier care nu este socket";
+                return false;
+            }
+            int proba = socket(AF_UNIX, SOCK_STREAM, 0);
+            bool folosit = proba >= 0 && connect(proba, (sockaddr*)&adresa, sizeof(adresa)) == 0;
+            if (proba >= 0)
+                close(proba);
+            if (folosit) {
+                eroare = "socket-ul este folosit de un alt server";
+                return false;
+            }
+            unlink(cale.c_str());
+        }
+        server = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (server < 0 || bind(server, (sockaddr*)&adresa, sizeof(adresa)) != 0 || listen(server, 8) != 0) {
+            eroare = strerror(errno);
+            if (server >= 0)
+                close(server);
+            server = -1;
+            return false;
+        }
+        cale_socket = cale;
+        oprire.store(false);
+        fir = thread([this] { deserveste(); });
+        return true;
+    }
+
+    /* Intoarce false daca serverul nu rula. */
+    bool opreste() {
+        lock_guard<mutex> blocare(m);
+        if (!fir.joinable())
+            return false;
+        oprire.store(true);
+        fir.join();
+        close(server);
+        server = -1;
+        unlink(cale_socket.c_str());
+        return true;
+    }
+
+    bool esteActiv() {
+        lock_guard<mutex> blocare(m);
+        return fir.joinable();
+    }
+
+    string cale() {
+        lock_guard<mutex> blocare(m);
+        return cale_socket;
+    }
+
+private:
+    void deserveste() {
+        while (!oprire.load()) {
+            /* Asteptarea cu limita de timp lasa firul sa observe cererea de oprire. */
+            pollfd asteptare = { server, POLLIN, 0 };
+            int gata = poll(&asteptare, 1, 200);
+            if (gata < 0 && errno != EINTR)
+                break;
+            if (gata <= 0)
+                continue;
+            int client = accept(server, nullptr, nullptr);
+            if (client < 0) {
+                if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN || errno == EWOULDBLOCK)
+                    continue;
+                if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                    /* Lipsa temporara de resurse: se reincearca mai tarziu, fara sa se consume procesorul. */
+                    this_thread::sleep_for(chrono::milliseconds(100));
+                    continue;
+                }
+                break;
+            }
+            timeval limita = { 2, 0 };
+            setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &limita, sizeof(limita));
+            setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &limita, sizeof(limita));
+            char cerere[1024];
+            if (recv(client, cerere, sizeof(cerere), 0) > 0) { /* Continutul cererii nu conteaza. */
+                ostringstream corp;
+                scrieMetriciPrometheus(corp);
+                string raspuns = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+                    + to_string(corp.str().size()) + "\r\n\r\n" + corp.str();
+                for (size_t trimis = 0; trimis < raspuns.size();) {
+#if defined(MSG_NOSIGNAL)
+                    ssize_t n = send(client, raspuns.data() + trimis, raspuns.size() - trimis, MSG_NOSIGNAL);
+#else
+                    ssize_t n = send(client, raspuns.data() + trimis, raspuns.size() - trimis, 0);
+#endif
+                    if (n <= 0)
+                        break;
+                    trimis += (size_t)n;
+                }
+            }
+            close(client);
+        }
+    }
+
+    mutex m;
+    thread fir;
+    int server = -1;
+    string cale_socket;
+    atomic<bool> oprire{ false };
+};
+
+ServerMetrici& serverMetrici() {
+    static ServerMetrici server;
+    return server;
+}
+#endif
+
+/* Testul diferential: fiecare kernel al fiecarui algoritm este comparat cu implementarea de referinta pe lungimi, alinieri,
+impartiri in bucati si puncte de combinare alese aleator (cu o samanta data, deci reproductibil), plus valorile de verificare
+ale sirului "123456789". Kernel-urile rapide se folosesc doar daca dau exact aceleasi rezultate. */
+
+/* Starea registrului dinaintea primului octet si transformarea ei in codul final, pentru fiecare algoritm. */
+uint64_t stareInitiala(AlgoritmCRC algoritm) {
+    switch (algoritm) {
+    case algoritm_crc32: return 0xFFFFFFFF;
+    case algoritm_crc64: return 0xFFFFFFFFFFFFFFFFull;
+    default: return 0;
+    }
+}
+
+uint64_t finalizare(AlgoritmCRC algoritm, uint64_t stare) {
+    switch (algoritm) {
+    case algoritm_crc32: return (CRC32)stare ^ 0xFFFFFFFF;
+    case algoritm_crc7: return (CRC7)stare >> 1;
+    case algoritm_crc64: return stare ^ 0xFFFFFFFFFFFFFFFFull;
+    default: return stare;
+    }
+}
+
+bool kernelDisponibil(AlgoritmCRC algoritm, KernelCRC kernel) {
+    return kernel == kernel_tabel || (kernel == kernel_intercalat && (algoritm == algoritm_crc32 || algoritm == algoritm_crc16))
+        || (kernel == kernel_pliere && pliereDisponibila(algoritm));
+}
+
+/* Ruleaza un anumit kernel, ocolind alegerea automata din actualizareCRC. */
+uint64_t actualizareCuKernel(AlgoritmCRC algoritm, KernelCRC kernel, uint64_t stare, const unsigned char* date, size_t lungime) {
+    if (kernel == kernel_pliere)
+        return kernelPliere(algoritm, stare, date, lungime);
+    switch (algoritm) {
+    case algoritm_crc32: return kernel == kernel_intercalat ? kernelIntercalatCRC32((CRC32)stare, date, lungime) : kernelTabelCRC32((CRC32)stare, date, lungime);
+    case algoritm_crc16: return kernel == kernel_intercalat ? kernelIntercalatCRC16((CRC16)stare, date, lungime) : kernelTabelCRC16((CRC16)stare, date, lungime);
+    case algoritm_crc64: return kernelTabelCRC64(stare, date, lungime);
+    default: return kernelTabelCRC7((CRC7)stare, date, lungime);
+    }
+}
+
+/* Indicele caii "dispecer" (actualizareCRC, cu alegerea kernel-ului, metrici si histograme), dupa cele ale kernel-urilor. */
+#define CALE_DISPECER numar_kerneluri
+
+/* Intrarea publica actualizareCRC a algoritmului, cu alegerea automata a kernel-ului. */
+uint64_t actualizareCuDispecer(AlgoritmCRC algoritm, uint64_t stare, const unsigned char* date, size_t lungime) {
+    switch (algoritm) {
+    case algoritm_crc32: return actualizareCRC32((CRC32)stare, date, lungime);
+    case algoritm_crc16: return actualizareCRC16((CRC16)stare, date, lungime);
+    case algoritm_crc64: return actualizareCRC64(stare, date, lungime);
+    default: return actualizareCRC7((CRC7)stare, date, lungime);
+    }
+}
+
+/* Combinarea, pentru algoritmii care o au. */
+bool combinare(AlgoritmCRC algoritm, uint64_t crc1, uint64_t crc2, uint64_t lungime2, uint64_t& rezultat) {
+    switch (algoritm) {
+    case algoritm_crc32: rezultat = combinaCRC32((CRC32)crc1, (CRC32)crc2, lungime2); return true;
+    case algoritm_crc16: rezultat = combinaCRC16((CRC16)crc1, (CRC16)crc2, lungime2); return true;
+    case algoritm_crc64: rezultat = combinaCRC64(crc1, crc2, lungime2); return true;
+    default: return false;
+    }
+}
+
+/* Compara toate caile de calcul pentru un mesaj. Punctele de taiere (crescatoare, cel mult lungimea) dau impartirea in bucati.
+Intoarce numarul de nepotriviri si le descrie in "raport". */
+int verificareMesaj(const unsigned char* date, size_t lungime, const vector<size_t>& taieturi, ostream& raport) {
+    int nepotriviri = 0;
+    for (int a = 0; a < numar_algoritmi; a++) {
+        AlgoritmCRC algoritm = (AlgoritmCRC)a;
+        uint64_t asteptat = calculCRCReferinta(modele[algoritm], date, lungime);
+        /* Pe langa kernel-uri se verifica si calea "dispecer", prin intrarile publice, cu aceleasi lungimi, alinieri si taieturi. */
+        for (int cale = 0; cale <= numar_kerneluri; cale++) {
+            if (cale != CALE_DISPECER && !kernelDisponibil(algoritm, (KernelCRC)cale))
+                continue;
+            auto actualizare = [&](uint64_t stare, const unsigned char* bucata, size_t lungime_bucata) {
+                return cale == CALE_DISPECER ? actualizareCuDispecer(algoritm, stare, bucata, lungime_bucata)
+                    : actualizareCuKernel(algoritm, (KernelCRC)cale, stare, bucata, lungime_bucata);
+            };
+            uint64_t intreg = finalizare(algoritm, actualizare(stareInitiala(algoritm), date, lungime));
+            uint64_t stare = stareInitiala(algoritm);
+            size_t inceput = 0;
+            for (size_t taietura : taieturi) {
+                stare = actualizare(stare, date + inceput, taietura - inceput);
+                inceput = taietura;
+            }
+            uint64_t pe_bucati = finalizare(algoritm, actualizare(stare, date + inceput, lungime - inceput));
+            if (intreg != asteptat || pe_bucati != asteptat) {
+                nepotriviri++;
+                raport << hex << modele[algoritm].nume << " / " << (cale == CALE_DISPECER ? "dispecer" : nume_kerneluri[cale]) << ": lungime " << dec << lungime
+                    << ", aliniere " << ((uintptr_t)date & 63) << ", referinta " << hex << asteptat << ", intreg " << intreg << ", pe bucati " << pe_bucati << endl;
+            }
+        }
+        /* Combinarea se verifica pe fiecare punct de taiere: CRC(A) combinat cu CRC(B) trebuie sa fie CRC(AB). */
+        for (size_t taietura : taieturi) {
+            uint64_t combinat;
+            uint64_t crc1 = calculCRCReferinta(modele[algoritm], date, taietura);
+            uint64_t crc2 = calculCRCReferinta(modele[algoritm], date + taietura, lungime - taietura);
+            if (combinare(algoritm, crc1, crc2, lungime - taietura, combinat) && combinat != asteptat) {
+                nepotriviri++;
+                raport << modele[algoritm].nume << " / combinare: lungime " << dec << lungime << ", taietura " << taietura
+                    << ", referinta " << hex << asteptat << ", combinat " << combinat << endl;
+            }
+        }
+    }
+    return nepotriviri;
+}
+
+/* Valorile de verificare din catalog, atat pentru referinta cat si pentru functiile calculCRC din program. */
+int verificareValoriCatalog(ostream& raport) {
+    const string sir = "123456789";
+    int nepotriviri = 0;
+    for (int a = 0; a < numar_algoritmi; a++) {
+        uint64_t referinta = calculCRCReferinta(modele[a], (const unsigned char*)sir.data(), sir.size());
+        if (referinta != modele[a].verificare) {
+            nepotriviri++;
+            raport << modele[a].nume << ": referinta da " << hex << referinta << " in loc de " << modele[a].verificare << endl;
+        }
+    }
+    uint64_t program[numar_algoritmi] = { calculCRC32(sir), calculCRC16(sir), calculCRC7(sir), calculCRC64(sir) };
+    for (int a = 0; a < numar_algoritmi; a++)
+        if (program[a] != modele[a].verificare) {
+            nepotriviri++;
+            raport << modele[a].nume << ": calculCRC da " << hex << program[a] << " in loc de " << modele[a].verificare << endl;
+        }
+    return nepotriviri;
+}
+
+#if defined(__cpp_impl_coroutine)
+/* Corutina minimala (porneste imediat, se distruge singura la final), pentru verificarea lui AsteptareCRC. */
+struct SarcinaCorutina {
+    struct promise_type {
+        SarcinaCorutina get_return_object() { return {}; }
+        suspend_never initial_suspend() noexcept { return {}; }
+        suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { terminate(); }
+    };
+};
+
+SarcinaCorutina corutinaVerificare(FluxCRC32& flux, const unsigned char* date, const vector<size_t>& lungimi,
+    function<void(coroutine_handle<>)> reluare, promise<void>& gata) {
+    size_t inceput = 0;
+    for (size_t lungime : lungimi) {
+        co_await flux.actualizare_coroutina(date + inceput, lungime, reluare);
+        inceput += lungime;
+    }
+    gata.set_value();
+}
+
+/* co_await pe ambele cai: reluare directa pe firul de calcul si reluare printr-o bucla de evenimente (aici firul apelant).
+Lungimile trec prin calea sincrona, prin cea interactiva (o felie si mai multe felii) si prin cea masiva. In varianta cu bucla, functia de reluare asteapta
+pana cand bucla a reluat corutina (care la ultimul co_await se si termina) si abia apoi se intoarce, ca o functie care ar
+folosi obiectul awaitable dupa reluare sa fie prinsa (de exemplu cu -fsanitize=address). */
+int verificareAsteptare(uint64_t samanta, ostream& raport) {
+    int nepotriviri = 0;
+    vector<size_t> lungimi = { 100, PRAG_ASYNC, FELIE_MASIVA - 1, 2 * FELIE_MASIVA + 7, PRAG_MASIV + 3 };
+    size_t total = 0, asincrone = 0;
+    for (size_t lungime : lungimi) {
+        total += lungime;
+        asincrone += lungime >= PRAG_ASYNC;
+    }
+    mt19937_64 generator(samanta);
+    vector<unsigned char> buffer(total);
+    for (unsigned char& octet : buffer)
+        octet = (unsigned char)generator();
+    const unsigned char* date = buffer.data();
+    CRC32 asteptat = (CRC32)calculCRCReferinta(modele[algoritm_crc32], date, total);
+    for (int prin_bucla = 0; prin_bucla < 2; prin_bucla++)
+        for (int repetare = 0; repetare < 8; repetare++) {
+            FluxCRC32 flux;
+            promise<void> gata;
+            future<void> terminat = gata.get_future();
+            CoadaMarginita<coroutine_handle<>> bucla(16);
+            CoadaMarginita<int> reluata(16);
+            atomic<size_t> reluari{ 0 };
+            function<void(coroutine_handle<>)> reluare;
+            if (prin_bucla)
+                reluare = [&bucla, &reluata, &reluari](coroutine_handle<> corutina) {
+                    bucla.pune(corutina);
+                    int semnal;
+                    reluata.scoate(semnal);
+                    reluari++;
+                };
+            corutinaVerificare(flux, date, lungimi, reluare, gata);
+            if (prin_bucla) {
+                while (terminat.wait_for(chrono::seconds(0)) != future_status::ready) {
+                    coroutine_handle<> corutina;
+                    bucla.scoate(corutina);
+                    corutina.resume();
+                    reluata.pune(1);
+                }
+                /* Functiile de reluare inca active folosesc variabilele de mai sus. */
+                while (reluari.load() < asincrone)
+                    this_thread::yield();
+            }
+            terminat.get();
+            if (flux.valoare() != asteptat) {
+                nepotriviri++;
+                raport << "AsteptareCRC (" << (prin_bucla ? "bucla de evenimente" : "reluare directa") << "): rezultat " << hex
+                    << flux.valoare() << ", referinta " << asteptat << dec << endl;
+            }
+        }
+    return nepotriviri;
+}
+#endif
+
+#if defined(CHECKSUM_ZLIB_ABI) && (defined(__unix__) || defined(__APPLE__))
+int verificareZlibABI(uint64_t samanta, ostream& raport);
+#endif
+int verificareTabelDispersie(uint64_t samanta, ostream& raport);
+
+int testDiferential(uint64_t iteratii, uint64_t samanta, ostream& raport) {
+    mt19937_64 generator(samanta);
+    int nepotriviri = verificareValoriCatalog(raport);
+    vector<unsigned char> buffer(PRAG_MASIV + 2 * FELIE_MASIVA + 64);
+
+    for (uint64_t i = 0; i < iteratii && nepotriviri < 20; i++) {
+        /* Majoritatea mesajelor sunt scurte; din cand in cand apare unul mai lung decat pragurile de calcul asincron. */
+        size_t lungime = generator() % 8 == 0 ? generator() % 8192 : generator() % 256;
+        size_t aliniere = generator() % 64;
+        for (size_t j = 0; j < lungime; j++)
+            buffer[aliniere + j] = (unsigned char)generator();
+        vector<size_t> taieturi(generator() % 5);
+        for (size_t& taietura : taieturi)
+            taietura = lungime ? generator() % (lungime + 1) : 0;
+        sort(taieturi.begin(), taieturi.end());
+        nepotriviri += verificareMesaj(buffer.data() + aliniere, lungime, taieturi, raport);
+    }
+
+    /* Kernel-ul multi-buffer, pe cate 4 mesaje de lungimi diferite. */
+    for (uint64_t i = 0; i < iteratii / 16 + 1 && nepotriviri < 20; i++) {
+        const unsigned char* mesaje[NUMAR_BUFFERE];
+        size_t lungimi[NUMAR_BUFFERE];
+        CRC32 stari[NUMAR_BUFFERE];
+        for (int b = 0; b < NUMAR_BUFFERE; b++) {
+            mesaje[b] = buffer.data() + generator() % 4096;
+            lungimi[b] = generator() % 1024;
+            stari[b] = 0xFFFFFFFF;
+        }
+        for (size_t j = 0; j < 4096 + 1024; j++)
+            buffer[j] = (unsigned char)generator();
+        kernelMultiBufferCRC32(mesaje, lungimi, stari);
+        for (int b = 0; b < NUMAR_BUFFERE; b++)
+            if ((stari[b] ^ 0xFFFFFFFF) != calculCRCReferinta(modele[algoritm_crc32], mesaje[b], lungimi[b])) {
+                nepotriviri++;
+                raport << "CRC-32/ISO-HDLC / multibuffer: mesajul " << b << ", lungime " << dec << lungimi[b] << endl;
+            }
+    }
+
+    /* Calea asincrona (feliere + combinare) pentru un mesaj mare, cu un prefix procesat sincron. */
+    size_t lungime = buffer.size() - 64;
+    for (size_t j = 0; j < lungime; j++)
+        buffer[j] = (unsigned char)generator();
+    FluxCRC32 flux;
+    flux.actualizare(buffer.data(), 100);
+    flux.actualizare_async(buffer.data() + 100, lungime - 100).get();
+    if (flux.valoare() != calculCRCReferinta(modele[algoritm_crc32], buffer.data(), lungime)) {
+        nepotriviri++;
+        raport << "FluxCRC32 asincron: lungime " << dec << lungime << ", rezultat gresit " << hex << flux.valoare() << endl;
+    }
+    /* Calea interactiva, parcursa in mai multe felii. */
+    FluxCRC32 flux_interactiv;
+    flux_interactiv.actualizare_async(buffer.data(), 3 * FELIE_MASIVA + 5).get();
+    if (flux_interactiv.valoare() != calculCRCReferinta(modele[algoritm_crc32], buffer.data(), 3 * FELIE_MASIVA + 5)) {
+        nepotriviri++;
+        raport << "FluxCRC32 asincron interactiv: rezultat gresit " << hex << flux_interactiv.valoare() << endl;
+    }
+#if defined(__cpp_impl_coroutine)
+    nepotriviri += verificareAsteptare(samanta, raport);
+#endif
+#if defined(CHECKSUM_ZLIB_ABI) && (defined(__unix__) || defined(__APPLE__))
+    nepotriviri += verificareZlibABI(samanta, raport);
+#endif
+    nepotriviri += verificareTabelDispersie(samanta, raport);
+
+    /* Motoarele generice (pliere cu constante calculate la inregistrare) pentru modelele de baza si pentru tot catalogul. */
+    for (int a = 0; a < numar_algoritmi; a++)
+        nepotriviri += verificareMotor(inregistreazaModel(modele[a]), samanta + a, raport);
+    for (size_t m = 0; m < numar_modele_catalog; m++)
+        nepotriviri += verificareMotor(inregistreazaModel(catalog_modele[m]), samanta + m, raport);
+    return nepotriviri;
+}
+
+/* Initializarea tuturor tabelelor, o singura data, pentru modurile fara meniu (fuzzing, biblioteca). */
+void initializare_tabele() {
+    static once_flag o_data;
+    call_once(o_data, [] {
+        initializare_tabel32();
+        initializare_tabel16();
+        initializare_tabel7();
+        initializare_tabel64();
+    });
+}
+
+#if defined(CHECKSUM_FUZZ)
+/* Punct de intrare pentru libFuzzer:
+    clang++ -std=c++17 -O2 -g -fsanitize=fuzzer,address -DCHECKSUM_FUZZ checksum.cpp -o checksum_fuzz
+Primii 4 octeti aleg punctele de taiere, restul este mesajul. Orice nepotrivire opreste fuzzer-ul. */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* date, size_t lungime) {
+    initializare_tabele();
+    if (lungime < 4)
+        return 0;
+    const unsigned char* mesaj = date + 4;
+    size_t lungime_mesaj = lungime - 4;
+    vector<size_t> taieturi;
+    for (int i = 0; i < 4; i++)
+        taieturi.push_back(lungime_mesaj ? date[i] * lungime_mesaj / 255 : 0);
+    sort(taieturi.begin(), taieturi.end());
+    ostringstream raport;
+    if (verificareMesaj(mesaj, lungime_mesaj, taieturi, raport)) {
+        cerr << raport.str();
+        abort();
+    }
+    return 0;
+}
+#endif
+
+/* Deduplicare la nivel de bloc.
+Fisierele sunt impartite in blocuri (de dimensiune fixa sau definite de continut), iar pentru fiecare bloc se calculeaza CRC-64.
+Indexul este o tabela de dispersie cu adresare deschisa, cu cheia CRC-64. Doua blocuri sunt declarate identice doar dupa
+compararea octet cu octet, care se face numai cand CRC-urile coincid; asa viteza scanarii este data de calculul CRC,
+nu de un hash criptografic.
+
+La blocurile definite de continut (content-defined chunking), limitele sunt alese cu un hash "gear" rulant: o limita apare
+cand bitii de jos ai hash-ului sunt toti 0. O inserare la inceputul unui fisier muta doar limitele din apropiere,
+deci blocurile de dupa ea sunt in continuare gasite ca duplicate. */
+
+struct OptiuniDeduplicare {
+    bool continut_variabil = true;
+    size_t dimensiune_medie = 8192;     /* Dimensiunea blocurilor fixe, respectiv media blocurilor definite de continut. */
+};
+
+struct RaportDeduplicare {
+    uint64_t fisiere = 0;
+    uint64_t blocuri = 0;
+    uint64_t blocuri_unice = 0;
+    uint64_t octeti = 0;
+    uint64_t octeti_duplicati = 0;
+    uint64_t coliziuni_crc = 0;         /* CRC egal, continut diferit. */
+    double secunde = 0;
+};
+
+class IndexBlocuri {
+public:
+    struct Intrare {
+        CRC64 crc;
+        uint32_t fisier;
+        uint32_t lungime;
+        uint64_t pozitie;
+    };
+
+    IndexBlocuri() : intrari(1024), ocupate(1024, false) {}
+
+    /* Apeleaza "potrivire" pentru fiecare intrare cu acelasi CRC, pana cand ea intoarce true.
+    Intoarce true daca una dintre intrari s-a potrivit. */
+    template<typename Functie>
+    bool cauta(CRC64 crc, Functie potrivire) const {
+        size_t masca = intrari.size() - 1;
+        for (size_t i = (size_t)crc & masca; ocupate[i]; i = (i + 1) & masca) /* Cautare liniara (linear probing). */
+            if (intrari[i].crc == crc && potrivire(intrari[i]))
+                return true;
+        return false;
+    }
+
+    void adauga(const Intrare& intrare) {
+        if ((numar + 1) * 10 > intrari.size() * 7) /* Factor de incarcare maxim 0.7. */
+            mareste();
+        pune(intrare);
+        numar++;
+    }
+
+private:
+    void pune(const Intrare& intrare) {
+        size_t masca = intrari.size() - 1;
+        size_t i = (size_t)intrare.crc & masca;
+        while (ocupate[i])
+            i = (i + 1) & masca;
+        intrari[i] = intrare;
+        ocupate[i] = true;
+    }
+
+    void mareste() {
+        vector<Intrare> vechi_intrari(intrari.size() * 2);
+        vector<bool> vechi_ocupate(ocupate.size() * 2, false);
+        vechi_intrari.swap(intrari);
+        vechi_ocupate.swap(ocupate);
+        for (size_t i = 0; i < vechi_intrari.size(); i++)
+            if (vechi_ocupate[i])
+                pune(vechi_intrari[i]);
+    }
+
+    vector<Intrare> intrari;
+    vector<bool> ocupate;
+    size_t numar = 0;
+};
+
+class ScanerDeduplicare {
+public:
+    explicit ScanerDeduplicare(const OptiuniDeduplicare& optiuni) : optiuni(optiuni) {
+        /* Tabelul pentru hash-ul gear: 256 de valori pseudo-aleatoare fixe, ca limitele sa fie aceleasi la fiecare rulare. */
+        mt19937_64 generator(0x6765617268617368ull);
+        for (uint64_t& valoare : gear)
+            valoare = generator();
+        int biti = 0;
+        while (((size_t)2 << biti) <= optiuni.dimensiune_medie)
+            biti++;
+        masca_limita = (1ull << biti) - 1;
+    }
+
+    /* "harta", daca nu este nula, primeste cate o linie pentru fiecare bloc: cale, pozitie, lungime, CRC-64 si, pentru duplicate, originalul.
+    Fisierele care nu pot fi citite sunt semnalate in "iesire". */
+    RaportDeduplicare scaneaza(const string& cale, ostream* harta, ostream& iesire) {
+        RaportDeduplicare raport;
+        auto inceput = chrono::steady_clock::now();
+        parcurgeFisiere(cale, [&](const string& nume) { scaneazaFisier(nume, harta, raport, iesire); });
+        raport.secunde = chrono::duration<double>(chrono::steady_clock::now() - inceput).count();
+        return raport;
+    }
+
+private:
+    size_t minim() const { return optiuni.continut_variabil ? optiuni.dimensiune_medie / 4 : optiuni.dimensiune_medie; }
+    size_t maxim() const { return optiuni.continut_variabil ? optiuni.dimensiune_medie * 8 : optiuni.dimensiune_medie; }
+
+    /* Lungimea urmatorului bloc care incepe la "date", din cei "disponibili" octeti. */
+    size_t limitaBloc(const unsigned char* date, size_t disponibili) const {
+        size_t limita = min(disponibili, maxim());
+        if (!optiuni.continut_variabil || limita <= minim())
+            return limita;
+        uint64_t hash = 0;
+        for (size_t i = minim(); i < limita; i++) {
+            hash = (hash << 1) + gear[date[i]];
+            if ((hash & masca_limita) == 0)
+                return i + 1;
+        }
+        return limita;
+    }
+
+    void scaneazaFisier(const string& nume, ostream* harta, RaportDeduplicare& raport, ostream& iesire) {
+        ifstream intrare(nume, ios::binary);
+        if (!intrare) {
+            iesire << "Fisierul " << nume << " nu poate fi deschis." << endl;
+            return;
+        }
+        uint32_t fisier = (uint32_t)fisiere.size();
+        fisiere.push_back(nume);
+        raport.fisiere++;
+
+        vector<unsigned char> buffer(max<size_t>(4 * 1024 * 1024, 2 * maxim()));
+        size_t inceput = 0, sfarsit = 0;
+        uint64_t pozitie = 0;
+        bool terminat = false;
+        for (;;) {
+            /* Se pastreaza in buffer cel putin un bloc de lungime maxima, daca fisierul mai are atatia octeti. */
+            if (!terminat && sfarsit - inceput < maxim()) {
+                memmove(buffer.data(), buffer.data() + inceput, sfarsit - inceput);
+                sfarsit -= inceput;
+                inceput = 0;
+                intrare.read((char*)buffer.data() + sfarsit, buffer.size() - sfarsit);
+                sfarsit += (size_t)intrare.gcount();
+                terminat = !intrare;
+            }
+            if (inceput == sfarsit)
+                break;
+            size_t lungime = limitaBloc(buffer.data() + inceput, sfarsit - inceput);
+            adaugaBloc(fisier, pozitie, buffer.data() + inceput, lungime, harta, raport);
+            inceput += lungime;
+            pozitie += lungime;
+        }
+    }
+
+    void adaugaBloc(uint32_t fisier, uint64_t pozitie, const unsigned char* date, size_t lungime, ostream* harta, RaportDeduplicare& raport) {
+        CRC64 crc = actualizareCRC64(0xFFFFFFFFFFFFFFFFull, date, lungime) ^ 0xFFFFFFFFFFFFFFFFull;
+        const IndexBlocuri::Intrare* original = nullptr;
+        index.cauta(crc, [&](const IndexBlocuri::Intrare& candidat) {
+            if (candidat.lungime == lungime && continutEgal(candidat, date)) {
+                original = &candidat;
+                return true;
+            }
+            raport.coliziuni_crc++;
+            return false;
+        });
+
+        raport.blocuri++;
+        raport.octeti += lungime;
+        if (original)
+            raport.octeti_duplicati += lungime;
+        else {
+            raport.blocuri_unice++;
+            index.adauga({ crc, fisier, (uint32_t)lungime, pozitie });
+        }
+        if (harta) {
+            char cod[17];
+            snprintf(cod, sizeof(cod), "%016llx", (unsigned long long)crc);
+            *harta << fisiere[fisier] << "\t" << dec << pozitie << "\t" << lungime << "\t" << cod;
+            if (original)
+                *harta << "\t" << fisiere[original->fisier] << ":" << original->pozitie;
+            *harta << "\n";
+        }
+    }
+
+    /* Compara blocul curent cu un bloc din index, recitit de pe disc. */
+    bool continutEgal(const IndexBlocuri::Intrare& candidat, const unsigned char* date) {
+        if (fisier_deschis != candidat.fisier) {
+            candidat_fisier.close();
+            candidat_fisier.clear();
+            candidat_fisier.open(fisiere[candidat.fisier], ios::binary);
+            fisier_deschis = candidat.fisier;
+        }
+        vector<unsigned char>& octeti = buffer_comparare;
+        octeti.resize(candidat.lungime);
+        candidat_fisier.clear();
+        candidat_fisier.seekg((streamoff)candidat.pozitie);
+        candidat_fisier.read((char*)octeti.data(), candidat.lungime);
+        return (size_t)candidat_fisier.gcount() == candidat.lungime && memcmp(octeti.data(), date, candidat.lungime) == 0;
+    }
+
+    OptiuniDeduplicare optiuni;
+    uint64_t gear[256];
+    uint64_t masca_limita;
+    vector<string> fisiere;
+    IndexBlocuri index;
+    ifstream candidat_fisier;
+    uint32_t fisier_deschis = UINT32_MAX;
+    vector<unsigned char> buffer_comparare;
+};
+
+/* Jurnal de inregistrari (append-only), ca un write-ahead log.
+Fisierul incepe cu un antet de 16 octeti: "CRCLOG01" si CRC32 al tuturor datelor din jurnal (inregistrarile puse cap la cap),
+urmat de 4 octeti rezervati. Fiecare inregistrare are lungimea (4 octeti), CRC32 al datelor ei (4 octeti) si apoi datele.
+Toate numerele sunt scrise little endian. CRC-ul intregului jurnal nu se recalculeaza: la fiecare adaugare el este combinat
+cu CRC-ul noii inregistrari.
+
+La deschidere se face scanarea de recuperare: inregistrarile sunt verificate cate 4 deodata cu kernel-ul multi-buffer,
+iar fisierul este trunchiat la prima inregistrare corupta sau incompleta (de exemplu, scrisa pe jumatate inainte de o cadere). */
+
+#define DIMENSIUNE_ANTET_JURNAL 16
+#define DIMENSIUNE_ANTET_INREGISTRARE 8
+
+void scrieLE32(unsigned char* destinatie, uint32_t valoare) {
+    for (int i = 0; i < 4; i++)
+        destinatie[i] = (unsigned char)(valoare >> (8 * i));
+}
+
+uint32_t citesteLE32(const unsigned char* sursa) {
+    return (uint32_t)sursa[0] | (uint32_t)sursa[1] << 8 | (uint32_t)sursa[2] << 16 | (uint32_t)sursa[3] << 24;
+}
+
+struct RaportRecuperare {
+    uint64_t inregistrari = 0;
+    uint64_t octeti_valizi = 0;         /* Lungimea fisierului dupa recuperare. */
+    uint64_t octeti_trunchiati = 0;
+    bool antet_corectat = false;
+    double secunde = 0;
+};
+
+class JurnalInregistrari {
+public:
+    /* Deschide jurnalul (il creeaza daca nu exista) si face scanarea de recuperare. */
+    bool deschide(const string& cale, RaportRecuperare& raport) {
+        error_code eroare;
+        if (!filesystem::exists(cale, eroare)) {
+            ofstream nou(cale, ios::binary);
+            unsigned char antet[DIMENSIUNE_ANTET_JURNAL] = { 'C', 'R', 'C', 'L', 'O', 'G', '0', '1' };
+            nou.write((const char*)antet, sizeof(antet));
+            if (!nou)
+                return false;
+        }
+        if (!recupereaza(cale, raport))
+            return false;
+        fisier.open(cale, ios::in | ios::out | ios::binary);
+        if (!fisier)
+            return false;
+        fisier.seekp(0, ios::end);
+        return true;
+    }
+
+    bool adauga(const void* date, uint32_t lungime) {
+        unsigned char antet[DIMENSIUNE_ANTET_INREGISTRARE];
+        CRC32 crc = actualizareCRC32(0xFFFFFFFF, (const unsigned char*)date, lungime) ^ 0xFFFFFFFF;
+        scrieLE32(antet, lungime);
+        scrieLE32(antet + 4, crc);
+        fisier.seekp(0, ios::end);
+        fisier.write((const char*)antet, sizeof(antet));
+        fisier.write((const char*)date, lungime);
+        fisier.flush();
+        /* Antetul se actualizeaza dupa ce inregistrarea a ajuns in fisier; daca programul cade intre cele doua scrieri,
+        recuperarea recalculeaza CRC-ul jurnalului din inregistrari. */
+        crc_jurnal = combinaCRC32(crc_jurnal, crc, lungime);
+        scrieCRCJurnal();
+        return (bool)fisier;
+    }
+
+    CRC32 crcJurnal() const { return crc_jurnal; }
+
+private:
+    bool recupereaza(const string& cale, RaportRecuperare& raport) {
+        auto inceput = chrono::steady_clock::now();
+        string continut;
+        if (!citireFisier(cale, continut) || continut.size() < DIMENSIUNE_ANTET_JURNAL || continut.compare(0, 8, "CRCLOG01") != 0)
+            return false;
+        const unsigned char* date = (const unsigned char*)continut.data();
+        size_t total = continut.size();
+
+        /* Intai se citesc doar anteturile, pana la prima inregistrare care ar depasi sfarsitul fisierului. */
+        vector<size_t> pozitii;
+        size_t pozitie = DIMENSIUNE_ANTET_JURNAL;
+        while (total - pozitie >= DIMENSIUNE_ANTET_INREGISTRARE && citesteLE32(date + pozitie) <= total - pozitie - DIMENSIUNE_ANTET_INREGISTRARE) {
+            pozitii.push_back(pozitie);
+            pozitie += DIMENSIUNE_ANTET_INREGISTRARE + citesteLE32(date + pozitie);
+        }
+
+        /* Apoi se verifica CRC-urile, cate NUMAR_BUFFERE inregistrari deodata. */
+        size_t valide = 0;
+        crc_jurnal = 0;
+        for (size_t grup = 0; grup < pozitii.size() && valide == grup; grup += NUMAR_BUFFERE) {
+            const unsigned char* mesaje[NUMAR_BUFFERE];
+            size_t lungimi[NUMAR_BUFFERE];
+            CRC32 stari[NUMAR_BUFFERE];
+            for (int b = 0; b < NUMAR_BUFFERE; b++) {
+                bool exista = grup + b < pozitii.size();
+                mesaje[b] = exista ? date + pozitii[grup + b] + DIMENSIUNE_ANTET_INREGISTRARE : date;
+                lungimi[b] = exista ? citesteLE32(date + pozitii[grup + b]) : 0;
+                stari[b] = 0xFFFFFFFF;
+            }
+            metrici.selectii_kernel[algoritm_crc32][kernel_multibuffer].fetch_add(1, memory_order_relaxed);
+            kernelMultiBufferCRC32(mesaje, lungimi, stari);
+            for (int b = 0; b < NUMAR_BUFFERE && grup + b < pozitii.size(); b++) {
+                CRC32 crc = stari[b] ^ 0xFFFFFFFF;
+                metrici.octeti[algoritm_crc32].fetch_add(lungimi[b], memory_order_relaxed);
+                if (crc != citesteLE32(date + pozitii[grup + b] + 4)) {
+                    metrici.nepotriviri.fetch_add(1, memory_order_relaxed);
+                    break;
+                }
+                crc_jurnal = combinaCRC32(crc_jurnal, crc, lungimi[b]);
+                valide++;
+            }
+        }
+
+        size_t sfarsit_valid = valide < pozitii.size() ? pozitii[valide] : pozitie;
+        raport.inregistrari = valide;
+        raport.octeti_valizi = sfarsit_valid;
+        raport.octeti_trunchiati = total - sfarsit_valid;
+        raport.antet_corectat = citesteLE32(date + 8) != crc_jurnal;
+        continut.clear();
+
+        error_code eroare;
+        if (raport.octeti_trunchiati)
+            filesystem::resize_file(cale, sfarsit_valid, eroare);
+        if (eroare)
+            return false;
+        if (raport.antet_corectat) {
+            fstream corectare(cale, ios::in | ios::out | ios::binary);
+            unsigned char crc[4];
+            scrieLE32(crc, crc_jurnal);
+            corectare.seekp(8);
+            corectare.write((const char*)crc, sizeof(crc));
+        }
+        raport.secunde = chrono::duration<double>(chrono::steady_clock::now() - inceput).count();
+        return true;
+    }
+
+    void scrieCRCJurnal() {
+        unsigned char crc[4];
+        scrieLE32(crc, crc_jurnal);
+        fisier.seekp(8);
+        fisier.write((const char*)crc, sizeof(crc));
+        fisier.flush();
+    }
+
+    fstream fisier;
+    CRC32 crc_jurnal = 0;
+};
+
+/* Resincronizarea cadrelor intr-un flux de octeti corupt (ex.: telemetrie primita pe o legatura seriala cu zgomot).
+Un cadru este [lungime (1 octet, optional)] [date] [CRC], iar CRC-ul acopera tot ce este inaintea lui.
+  - CRC-16/ARC: 2 octeti, little endian.
+  - CRC-7/MMC: 1 octet, CRC-ul pe bitii 7..1 si bitul de final 1 (ca in cadrele de comanda SD/MMC).
+In loc sa se calculeze separat CRC-ul pentru fiecare pereche (inceput, lungime), ceea ce ar costa O(n * L^2), se foloseste reziduul:
+trecand prin registru si octetii CRC-ului de la sfarsitul unui cadru corect, registrul ajunge mereu la aceeasi valoare (reziduul),
+indiferent de date. Deci pentru fiecare inceput posibil se avanseaza registrul cate un octet, iar la fiecare pas se compara cu reziduul:
+O(n * L) operatii, fiecare fiind o singura cautare in tabel.
+
+Un cadru gresit trece testul cu probabilitatea 2^-latime pentru fiecare pereche (inceput, lungime) incercata, asa ca din toti candidatii
+se alege (prin programare dinamica) un set de cadre care nu se suprapun si acopera cat mai multi octeti. */
+
+struct OptiuniResincronizare {
+    AlgoritmCRC algoritm = algoritm_crc16;  /* algoritm_crc16 sau algoritm_crc7. */
+    bool prefix_lungime = false;            /* Primul octet al cadrului da lungimea datelor. */
+    size_t date_minim = 1;
+    size_t date_maxim = 255;
+};
+
+struct CadruGasit {
+    size_t pozitie;
+    size_t lungime;                         /* Lungimea intregului cadru, inclusiv prefixul si CRC-ul. */
+};
+
+class ScanerCadre {
+public:
+    explicit ScanerCadre(const OptiuniResincronizare& optiuni) : optiuni(optiuni) {
+        latime_crc = optiuni.algoritm == algoritm_crc16 ? 2 : 1;
+        /* Reziduul este starea registrului dupa un cadru corect fara date. */
+        unsigned char cadru_gol[2];
+        if (optiuni.algoritm == algoritm_crc16) {
+            cadru_gol[0] = cadru_gol[1] = 0; /* CRC16 al sirului vid este 0. */
+            reziduu = pas(pas(0, cadru_gol[0]), cadru_gol[1]);
+        }
+        else {
+            cadru_gol[0] = 1; /* CRC7 al sirului vid este 0, plus bitul de final. */
+            reziduu = pas(0, cadru_gol[0]);
+        }
+    }
+
+    /* Toti candidatii, in ordinea pozitiilor. */
+    vector<CadruGasit> candidati(const unsigned char* date, size_t lungime) const {
+        vector<CadruGasit> gasiti;
+        size_t prefix = optiuni.prefix_lungime ? 1 : 0;
+        size_t cadru_minim = prefix + optiuni.date_minim + latime_crc;
+        size_t cadru_maxim = prefix + optiuni.date_maxim + latime_crc;
+        for (size_t inceput = 0; inceput < lungime; inceput++) {
+            size_t sfarsit_maxim = min(lungime, inceput + cadru_maxim);
+            if (optiuni.prefix_lungime) {
+                /* Lungimea este data de prefix, deci exista un singur candidat pentru fiecare inceput. */
+                size_t cadru = 1 + date[inceput] + latime_crc;
+                if (date[inceput] < optiuni.date_minim || date[inceput] > optiuni.date_maxim || inceput + cadru > lungime)
+                    continue;
+                sfarsit_maxim = inceput + cadru;
+            }
+            unsigned stare = 0;
+            for (size_t i = inceput; i < sfarsit_maxim; i++) {
+                stare = pas(stare, date[i]);
+                size_t cadru = i + 1 - inceput;
+                if (stare == reziduu && cadru >= cadru_minim && (!optiuni.prefix_lungime || i + 1 == sfarsit_maxim))
+                    gasiti.push_back({ inceput, cadru });
+            }
+        }
+        return gasiti;
+    }
+
+    /* Alege cadrele care nu se suprapun si acopera cei mai multi octeti: scor[i] = cel mai bun rezultat pentru octetii de la i la sfarsit.
+    La acelasi numar de octeti se prefera mai multe cadre: la CRC-urile cu valoare initiala 0 (ca CRC-16/ARC), doua cadre corecte
+    puse unul dupa altul formeaza si ele un "cadru" corect, care nu trebuie sa le inlocuiasca. */
+    static vector<CadruGasit> selecteaza(const vector<CadruGasit>& candidati, size_t lungime) {
+        vector<pair<uint64_t, uint64_t>> scor(lungime + 1, { 0, 0 }); /* (octeti acoperiti, numar de cadre) */
+        vector<long long> ales(lungime + 1, -1);
+        size_t urmatorul = candidati.size();
+        for (size_t i = lungime; i-- > 0;) {
+            scor[i] = scor[i + 1];
+            while (urmatorul > 0 && candidati[urmatorul - 1].pozitie >= i) {
+                urmatorul--;
+                const CadruGasit& c = candidati[urmatorul];
+                pair<uint64_t, uint64_t> cu_cadrul = { c.lungime + scor[i + c.lungime].first, 1 + scor[i + c.lungime].second };
+                if (cu_cadrul > scor[i]) {
+                    scor[i] = cu_cadrul;
+                    ales[i] = (long long)urmatorul;
+                }
+            }
+        }
+        vector<CadruGasit> rezultat;
+        for (size_t i = 0; i < lungime;) {
+            if (ales[i] >= 0 && scor[i] != scor[i + 1]) {
+                rezultat.push_back(candidati[ales[i]]);
+                i += candidati[ales[i]].lungime;
+            }
+            else
+                i++;
+        }
+        return rezultat;
+    }
+
+private:
+    unsigned pas(unsigned stare, unsigned char octet) const {
+        if (optiuni.algoritm == algoritm_crc16)
+            return (stare >> 8) ^ tabel_CRC16[(stare ^ octet) & 0xFF];
+        return tabel_CRC7[stare ^ octet];
+    }
+
+    OptiuniResincronizare optiuni;
+    size_t latime_crc;
+    unsigned reziduu;
+};
+
+/* Experimente privind eficacitatea detectiei erorilor.
+Un mesaj este transmis ca un cuvant de cod: datele urmate de CRC (little endian pentru CRC-urile reflectate, iar pentru CRC7
+un octet cu CRC-ul pe bitii 7..1). Cuvantul este corupt dupa un model de eroare, iar receptorul considera ultimii octeti ca fiind CRC-ul
+si recalculeaza CRC-ul datelor primite. Eroarea este nedetectata daca cele doua coincid.
+
+Pe langa inversarea de biti (distanta Hamming d dintre cuvantul trimis si cel primit), pe legaturile seriale apar si erori de sincronizare:
+  - inserare/stergere de bit: receptorul pierde sincronizarea, bitii de dupa eroare se deplaseaza cu o pozitie, iar lungimea cadrului
+    ramane aceeasi (la inserare ultimul bit se pierde, la stergere ultimul bit este completat cu 0 sau 1);
+  - inserare, stergere sau duplicare de octet: cadrul primit are un octet in plus sau in minus.
+Bitii unui octet sunt transmisi incepand cu cel mai putin semnificativ, ca la UART.
+
+Pentru mesaje mici (1 sau 2 octeti) se incearca toate mesajele si toate variantele fiecarei erori (exhaustiv), iar pentru mesajele mari
+se aleg aleator mesajul si eroarea (Monte Carlo). In ambele cazuri lucrul este impartit intre mai multe fire. */
+
+enum ModelEroare { eroare_inversare_biti, eroare_inserare_bit, eroare_stergere_bit, eroare_inserare_octet, eroare_stergere_octet, eroare_duplicare_octet, numar_modele_eroare };
+const char* nume_modele_eroare[numar_modele_eroare] = { "inversare biti", "inserare bit", "stergere bit", "inserare octet", "stergere octet", "duplicare octet" };
+
+/* CRC-urile folosite in experimente. */
+const AlgoritmCRC algoritmi_experiment[] = { algoritm_crc7, algoritm_crc16, algoritm_crc32 };
+#define NUMAR_ALGORITMI_EXPERIMENT 3
+
+size_t octetiCRC(AlgoritmCRC algoritm) {
+    return algoritm == algoritm_crc7 ? 1 : (size_t)modele[algoritm].latime / 8;
+}
+
+/* Octetii de CRC care se adauga dupa date. */
+void codareCRC(AlgoritmCRC algoritm, const unsigned char* date, size_t lungime, unsigned char* destinatie) {
+    uint64_t stare = actualizareCuKernel(algoritm, kernel_tabel, stareInitiala(algoritm), date, lungime);
+    if (algoritm == algoritm_crc7) {
+        destinatie[0] = (unsigned char)stare; /* Registrul CRC7 contine deja CRC-ul pe bitii 7..1. */
+        return;
+    }
+    uint64_t crc = finalizare(algoritm, stare);
+    for (size_t i = 0; i < octetiCRC(algoritm); i++)
+        destinatie[i] = (unsigned char)(crc >> (8 * i));
+}
+
+bool eroareNedetectata(AlgoritmCRC algoritm, const vector<unsigned char>& primit) {
+    size_t latime = octetiCRC(algoritm);
+    if (primit.size() < latime)
+        return false;
+    unsigned char crc[8];
+    codareCRC(algoritm, primit.data(), primit.size() - latime, crc);
+    return memcmp(crc, primit.data() + primit.size() - latime, latime) == 0;
+}
+
+bool bitCuvant(const vector<unsigned char>& cuvant, size_t bit) {
+    return (cuvant[bit / 8] >> (bit % 8)) & 1;
+}
+
+void scrieBit(vector<unsigned char>& cuvant, size_t bit, bool valoare) {
+    if (valoare)
+        cuvant[bit / 8] |= (unsigned char)(1 << (bit % 8));
+    else
+        cuvant[bit / 8] &= (unsigned char)~(1 << (bit % 8));
+}
+
+/* Numarul de variante ale unei erori pentru un cuvant de "m" octeti. La inversarea de biti, exhaustiv se trateaza doar d = 1 si d = 2. */
+uint64_t numarVariante(ModelEroare model, size_t m, int distanta) {
+    uint64_t biti = 8 * m;
+    switch (model) {
+    case eroare_inversare_biti: return distanta == 1 ? biti : biti * (biti - 1) / 2;
+    case eroare_inserare_bit:
+    case eroare_stergere_bit: return biti * 2;
+    case eroare_inserare_octet: return (m + 1) * 256;
+    default: return m;
+    }
+}
+
+void aplicaEroare(ModelEroare model, const vector<unsigned char>& cuvant, uint64_t varianta, int distanta, vector<unsigned char>& primit) {
+    size_t biti = 8 * cuvant.size();
+    primit = cuvant;
+    switch (model) {
+    case eroare_inversare_biti:
+        if (distanta == 1)
+            primit[varianta / 8] ^= (unsigned char)(1 << (varianta % 8));
+        else {
+            /* Perechea (i, j), i < j, cu numarul de ordine "varianta". */
+            size_t i = 0;
+            while (varianta >= biti - 1 - i) {
+                varianta -= biti - 1 - i;
+                i++;
+            }
+            size_t j = i + 1 + (size_t)varianta;
+            primit[i / 8] ^= (unsigned char)(1 << (i % 8));
+            primit[j / 8] ^= (unsigned char)(1 << (j % 8));
+        }
+        break;
+    case eroare_inserare_bit: {
+        size_t pozitie = (size_t)(varianta / 2);
+        for (size_t b = pozitie + 1; b < biti; b++)
+            scrieBit(primit, b, bitCuvant(cuvant, b - 1));
+        scrieBit(primit, pozitie, varianta & 1);
+        break;
+    }
+    case eroare_stergere_bit: {
+        size_t pozitie = (size_t)(varianta / 2);
+        for (size_t b = pozitie; b + 1 < biti; b++)
+            scrieBit(primit, b, bitCuvant(cuvant, b + 1));
+        scrieBit(primit, biti - 1, varianta & 1);
+        break;
+    }
+    case eroare_inserare_octet:
+        primit.insert(primit.begin() + (ptrdiff_t)(varianta / 256), (unsigned char)(varianta % 256));
+        break;
+    case eroare_stergere_octet:
+        primit.erase(primit.begin() + (ptrdiff_t)varianta);
+        break;
+    default:
+        primit.insert(primit.begin() + (ptrdiff_t)varianta, cuvant[varianta]);
+        break;
+    }
+}
+
+struct RezultatExperiment {
+    uint64_t incercari[numar_modele_eroare][NUMAR_ALGORITMI_EXPERIMENT] = {};
+    uint64_t nedetectate[numar_modele_eroare][NUMAR_ALGORITMI_EXPERIMENT] = {};
+};
+
+/* Evalueaza un cuvant corupt pentru toti algoritmii. Corupturile care dau exact cuvantul trimis nu sunt erori si nu se numara. */
+void evalueaza(ModelEroare model, int a, const vector<unsigned char>& cuvant, const vector<unsigned char>& primit, RezultatExperiment& rezultat) {
+    if (primit == cuvant)
+        return;
+    rezultat.incercari[model][a]++;
+    if (eroareNedetectata(algoritmi_experiment[a], primit))
+        rezultat.nedetectate[model][a]++;
+}
+
+/* lungime = octetii de date; exhaustiv: toate cele 256^lungime mesaje, altfel "incercari" mesaje si erori aleatoare pentru fiecare model. */
+RezultatExperiment experimentDetectie(size_t lungime, bool exhaustiv, uint64_t incercari, int distanta, uint64_t samanta) {
+    unsigned numar_fire = max(1u, thread::hardware_concurrency());
+    vector<RezultatExperiment> partiale(numar_fire);
+    vector<thread> fire;
+    uint64_t numar_mesaje = exhaustiv ? 1ull << (8 * lungime) : incercari;
+
+    for (unsigned f = 0; f < numar_fire; f++)
+        fire.emplace_back([&, f] {
+            RezultatExperiment& rezultat = partiale[f];
+            mt19937_64 generator(samanta + f);
+            vector<unsigned char> cuvant, primit;
+            for (uint64_t mesaj = f; mesaj < numar_mesaje; mesaj += numar_fire)
+                for (int a = 0; a < NUMAR_ALGORITMI_EXPERIMENT; a++) {
+                    AlgoritmCRC algoritm = algoritmi_experiment[a];
+                    cuvant.assign(lungime + octetiCRC(algoritm), 0);
+                    for (size_t i = 0; i < lungime; i++)
+                        cuvant[i] = exhaustiv ? (unsigned char)(mesaj >> (8 * i)) : (unsigned char)generator();
+                    codareCRC(algoritm, cuvant.data(), lungime, cuvant.data() + lungime);
+
+                    for (int m = 0; m < numar_modele_eroare; m++) {
+                        ModelEroare model = (ModelEroare)m;
+                        if (exhaustiv) {
+                            uint64_t variante = numarVariante(model, cuvant.size(), distanta);
+                            for (uint64_t v = 0; v < variante; v++) {
+                                aplicaEroare(model, cuvant, v, distanta, primit);
+                                evalueaza(model, a, cuvant, primit, rezultat);
+                            }
+                        }
+                        else if (model == eroare_inversare_biti) {
+                            /* d pozitii distincte, alese aleator. */
+                            primit = cuvant;
+                            vector<size_t> pozitii;
+                            while ((int)pozitii.size() < distanta) {
+                                size_t bit = generator() % (8 * cuvant.size());
+                                if (find(pozitii.begin(), pozitii.end(), bit) == pozitii.end())
+                                    pozitii.push_back(bit);
+                            }
+                            for (size_t bit : pozitii)
+                                primit[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+                            evalueaza(model, a, cuvant, primit, rezultat);
+                        }
+                        else {
+                            aplicaEroare(model, cuvant, generator() % numarVariante(model, cuvant.size(), distanta), distanta, primit);
+                            evalueaza(model, a, cuvant, primit, rezultat);
+                        }
+                    }
+                }
+        });
+    for (thread& fir : fire)
+        fir.join();
+
+    RezultatExperiment total;
+    for (const RezultatExperiment& partial : partiale)
+        for (int m = 0; m < numar_modele_eroare; m++)
+            for (int a = 0; a < NUMAR_ALGORITMI_EXPERIMENT; a++) {
+                total.incercari[m][a] += partial.incercari[m][a];
+                total.nedetectate[m][a] += partial.nedetectate[m][a];
+            }
+    return total;
+}
+
+void afisareExperiment(const RezultatExperiment& rezultat, int distanta, ostream& iesire) {
+    for (int m = 0; m < numar_modele_eroare; m++) {
+        iesire << nume_modele_eroare[m];
+        if (m == eroare_inversare_biti)
+            iesire << " (d = " << dec << distanta << ")";
+        iesire << ":" << endl;
+        for (int a = 0; a < NUMAR_ALGORITMI_EXPERIMENT; a++) {
+            const ModelCRC& model = modele[algoritmi_experiment[a]];
+            uint64_t incercari = rezultat.incercari[m][a], nedetectate = rezultat.nedetectate[m][a];
+            iesire << "    " << model.nume << ": " << dec << nedetectate << " nedetectate din " << incercari << " (rata "
+                << (incercari ? (double)nedetectate / incercari : 0) << ", fata de 2^-" << model.latime << " = " << ldexp(1.0, -model.latime) << ")" << endl;
+        }
+    }
+}
+
+/* Analiza "punctelor oarbe" ale unui model CRC: zerouri adaugate la inceput sau la sfarsit, trunchiere si extindere.
+Rezultatele sunt exacte si vin din algebra polinoamelor, in forma normala (ne-reflectata): dupa mesajul M registrul este
+R = (I * x^(8n) + M(x) * x^w) mod P, unde I este valoarea initiala, w latimea si P polinomul.
+Reflectarea doar reordoneaza bitii, iar XOR-ul final se aplica la fel ambelor coduri comparate, deci nu schimba raspunsurile.
+
+  - k zerouri la inceput: registrul initial devine I * x^(8k), deci eroarea nu se vede pentru NICIUN mesaj daca I * (x^(8k) + 1) = 0 mod P.
+    La CRC-16/ARC si CRC-7/MMC, I = 0, asa ca zerourile de la inceput sunt mereu invizibile.
+  - k zerouri la sfarsit: R devine R * x^(8k); nedetectat cand R * (x^(8k) + 1) = 0 mod P. Solutiile formeaza un subspatiu
+    de dimensiune d = grad(cmmdc(P, x^(8k) + 1)), deci fractia de mesaje afectate este 2^(d - w).
+  - trunchierea ultimilor k octeti T (sau extinderea cu k octeti T): nedetectat cand R' * (x^(8k) + 1) = T * x^w mod P.
+    Pentru R' si T uniforme, probabilitatea este 2^(d - w - r), unde r este rangul lui T * x^w in spatiul cat fata de imaginea
+    inmultirii cu (x^(8k) + 1); spatiul cat are dimensiunea d, deci r <= d, iar cand 8k >= w avem r = d si probabilitatea este exact 2^-w.
+Fractiile sunt calculate pentru mesaje de cel putin w/8 octeti, pentru care registrul R ia toate valorile la fel de des. */
+
+/* Inmultire modulo P in forma normala, pentru polinoame de grad mai mic decat latimea modelului. */
+uint64_t inmultireNormala(uint64_t a, uint64_t b, const ModelCRC& model) {
+    uint64_t masca = mascaLatime(model.latime), rezultat = 0;
+    for (int bit = model.latime - 1; bit >= 0; bit--) {
+        bool iesit = (rezultat >> (model.latime - 1)) & 1;
+        rezultat = (rezultat << 1) & masca;
+        if (iesit)
+            rezultat ^= model.polinom;
+        if ((a >> bit) & 1)
+            rezultat ^= b;
+    }
+    return rezultat;
+}
+
+/* x^n mod P, in forma normala. */
+uint64_t putereXNormala(uint64_t n, const ModelCRC& model) {
+    uint64_t rezultat = 1, baza = model.latime > 1 ? 2 : model.polinom; /* x mod P */
+    for (; n; n >>= 1) {
+        if (n & 1)
+            rezultat = inmultireNormala(rezultat, baza, model);
+        baza = inmultireNormala(baza, baza, model);
+    }
+    return rezultat;
+}
+
+int gradPolinom(unsigned __int128 polinom) {
+    int grad = -1;
+    for (; polinom; polinom >>= 1)
+        grad++;
+    return grad;
+}
+
+/* Cel mai mare divizor comun al lui P (cu termenul x^w) si al unui polinom de grad mai mic decat w. */
+unsigned __int128 cmmdcPolinoame(unsigned __int128 a, unsigned __int128 b) {
+    while (b) {
+        int grad_b = gradPolinom(b);
+        while (a && gradPolinom(a) >= grad_b)
+            a ^= b << (gradPolinom(a) - grad_b);
+        swap(a, b);
+    }
+    return a;
+}
+
+/* Eliminare Gauss peste GF(2): adauga vectorul la baza data (indexata dupa bitul conducator) si intoarce true daca era independent. */
+bool adaugaLaBaza(uint64_t vector_nou, uint64_t baza[64]) {
+    for (int bit = 63; bit >= 0; bit--) {
+        if (!((vector_nou >> bit) & 1))
+            continue;
+        if (!baza[bit]) {
+            baza[bit] = vector_nou;
+            return true;
+        }
+        vector_nou ^= baza[bit];
+    }
+    return false;
+}
+
+struct AnalizaOarba {
+    bool zerouri_inceput_invizibile;    /* Pentru toate mesajele. */
+    int grad_cmmdc;                     /* d = grad(cmmdc(P, x^(8k) + 1)) */
+    double fractie_zerouri_sfarsit;     /* 2^(d - w) */
+    double probabilitate_trunchiere;    /* 2^(d - w - r), la fel pentru extindere */
+};
+
+AnalizaOarba analizaPuncteOarbe(const ModelCRC& model, uint64_t k) {
+    AnalizaOarba analiza;
+    uint64_t masca = mascaLatime(model.latime);
+    uint64_t x8k_plus_1 = putereXNormala(8 * k, model) ^ 1; /* (x^(8k) + 1) mod P */
+    analiza.zerouri_inceput_invizibile = inmultireNormala(model.initial & masca, x8k_plus_1, model) == 0;
+
+    unsigned __int128 polinom_complet = ((unsigned __int128)1 << model.latime) | model.polinom;
+    analiza.grad_cmmdc = gradPolinom(cmmdcPolinoame(polinom_complet, x8k_plus_1));
+    analiza.fractie_zerouri_sfarsit = ldexp(1.0, analiza.grad_cmmdc - model.latime);
+
+    /* Imaginea inmultirii cu (x^(8k) + 1), apoi rangul vectorilor x^j * x^w (j < 8k) peste aceasta imagine. */
+    uint64_t baza[64] = {};
+    for (int i = 0; i < model.latime; i++)
+        adaugaLaBaza(inmultireNormala(putereXNormala((uint64_t)i, model), x8k_plus_1, model), baza);
+    int rang = 0;
+    uint64_t termen = putereXNormala((uint64_t)model.latime, model);
+    uint64_t x = putereXNormala(1, model);
+    for (uint64_t j = 0; j < 8 * k && rang < analiza.grad_cmmdc; j++) {
+        rang += adaugaLaBaza(termen, baza);
+        termen = inmultireNormala(termen, x, model);
+    }
+    analiza.probabilitate_trunchiere = ldexp(1.0, analiza.grad_cmmdc - model.latime - rang);
+    return analiza;
+}
+
+void afisarePuncteOarbe(uint64_t k_maxim, ostream& iesire) {
+    for (int a = 0; a < numar_algoritmi; a++) {
+        const ModelCRC& model = modele[a];
+        iesire << model.nume << " (w = " << dec << model.latime << ", I = " << hex << model.initial << dec << "):" << endl;
+        for (uint64_t k = 1; k <= k_maxim; k++) {
+            AnalizaOarba analiza = analizaPuncteOarbe(model, k);
+            iesire << "    k = " << k << ": zerouri la inceput " << (analiza.zerouri_inceput_invizibile ? "NEDETECTATE (toate mesajele)" : "detectate")
+                << "; zerouri la sfarsit nedetectate pentru 2^" << analiza.grad_cmmdc - model.latime << " = " << analiza.fractie_zerouri_sfarsit
+                << " din mesaje; trunchiere/extindere nedetectata cu probabilitatea " << analiza.probabilitate_trunchiere << endl;
+        }
+    }
+}
+
+/* Verificarea unui corpus de mesaje (cate unul pe linie): pentru fiecare mesaj si model se semnaleaza transformarile care nu schimba CRC-ul.
+Totul se face dintr-o singura trecere prin mesaj: starea dinaintea ultimului octet da trunchierea, un pas cu octetul 0 dupa final
+da zeroul adaugat, iar zeroul de la inceput nu depinde de mesaj (vezi analiza de mai sus). */
+enum TransformareMesaj { zero_inceput, zero_sfarsit, trunchiere_octet, numar_transformari };
+const char* nume_transformari[numar_transformari] = { "zero la inceput", "zero la sfarsit", "ultimul octet trunchiat" };
+
+void verificareCorpus(istream& corpus, ostream& iesire) {
+    uint64_t semnalate[numar_algoritmi][numar_transformari] = {};
+    vector<uint64_t> exemple[numar_algoritmi][numar_transformari];
+    bool zero_inceput_invizibil[numar_algoritmi];
+    for (int a = 0; a < numar_algoritmi; a++)
+        zero_inceput_invizibil[a] = analizaPuncteOarbe(modele[a], 1).zerouri_inceput_invizibile;
+
+    string linie;
+    uint64_t numar_linie = 0;
+    const unsigned char zero = 0;
+    while (getline(corpus, linie)) {
+        numar_linie++;
+        const unsigned char* date = (const unsigned char*)linie.data();
+        for (int a = 0; a < numar_algoritmi; a++) {
+            AlgoritmCRC algoritm = (AlgoritmCRC)a;
+            uint64_t prefix = actualizareCuKernel(algoritm, kernel_tabel, stareInitiala(algoritm), date, linie.empty() ? 0 : linie.size() - 1);
+            uint64_t complet = linie.empty() ? prefix : actualizareCuKernel(algoritm, kernel_tabel, prefix, date + linie.size() - 1, 1);
+            bool neschimbat[numar_transformari] = {
+                zero_inceput_invizibil[a],
+                actualizareCuKernel(algoritm, kernel_tabel, complet, &zero, 1) == complet,
+                !linie.empty() && prefix == complet,
+            };
+            for (int t = 0; t < numar_transformari; t++)
+                if (neschimbat[t]) {
+                    semnalate[a][t]++;
+                    if (exemple[a][t].size() < 5)
+                        exemple[a][t].push_back(numar_linie);
+                }
+        }
+    }
+
+    iesire << dec << numar_linie << " mesaje verificate." << endl;
+    for (int a = 0; a < numar_algoritmi; a++)
+        for (int t = 0; t < numar_transformari; t++) {
+            iesire << modele[a].nume << ", " << nume_transformari[t] << ": " << semnalate[a][t] << " mesaje cu CRC neschimbat";
+            if (!exemple[a][t].empty()) {
+                iesire << " (liniile";
+                for (uint64_t exemplu : exemple[a][t])
+                    iesire << " " << exemplu;
+                iesire << (semnalate[a][t] > exemple[a][t].size() ? " ...)" : ")");
+            }
+            iesire << endl;
+        }
+}
+
+/* Intrare text (hex sau base64) decodata direct in CRC32.
+Textul este citit pe blocuri, iar octetii decodati trec printr-un buffer mic (DIMENSIUNE_DECODARE) si apoi in starea CRC,
+deci continutul decodat nu este niciodata pastrat intreg in memorie.
+Pe x86 portiunile fara spatii sunt decodate cu SIMD: hex cu SSE2 (32 de caractere -> 16 octeti pe iteratie) si base64 cu SSSE3
+(16 caractere -> 12 octeti, algoritmul lui W. Mula cu tabele de cautare in registre). Restul (spatii, linii noi, padding "=",
+sfarsitul textului) trece prin decodorul scalar, care verifica si caracterele invalide. */
+
+enum FormatText { format_hex, format_base64 };
+
+#define DIMENSIUNE_DECODARE 4096
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DECODARE_SIMD
+#endif
+
+#if defined(DECODARE_SIMD)
+/* 32 de caractere hex -> 16 octeti. Intoarce false (fara sa scrie nimic) daca exista un caracter care nu este cifra hex. */
+__attribute__((target("sse2"))) bool decodareHex32(const char* text, unsigned char* destinatie) {
+    __m128i rezultate[2];
+    for (int jumatate = 0; jumatate < 2; jumatate++) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(text + 16 * jumatate));
+        __m128i litere_mici = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i cifra = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+        __m128i litera = _mm_and_si128(_mm_cmpgt_epi8(litere_mici, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(litere_mici, _mm_set1_epi8('f' + 1)));
+        if (_mm_movemask_epi8(_mm_or_si128(cifra, litera)) != 0xFFFF)
+            return false;
+        __m128i valoare = _mm_or_si128(_mm_and_si128(cifra, _mm_sub_epi8(v, _mm_set1_epi8('0'))),
+            _mm_andnot_si128(cifra, _mm_sub_epi8(litere_mici, _mm_set1_epi8('a' - 10))));
+        /* In fiecare pereche de octeti, primul caracter este jumatatea superioara a octetului decodat. */
+        __m128i superior = _mm_slli_epi16(_mm_and_si128(valoare, _mm_set1_epi16(0x00FF)), 4);
+        __m128i inferior = _mm_srli_epi16(valoare, 8);
+        rezultate[jumatate] = _mm_or_si128(superior, inferior);
+    }
+    _mm_storeu_si128((__m128i*)destinatie, _mm_packus_epi16(rezultate[0], rezultate[1]));
+    return true;
+}
+
+/* 16 caractere base64 -> 12 octeti (se scriu 16, ultimii 4 sunt nefolositi). Intoarce false daca un caracter nu este din alfabetul base64. */
+__attribute__((target("ssse3"))) bool decodareBase64_16(const char* text, unsigned char* destinatie) {
+    const __m128i tabel_inferior = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i tabel_superior = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i tabel_deplasare = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i masca_2F = _mm_set1_epi8(0x2F);
+
+    __m128i v = _mm_loadu_si128((const __m128i*)text);
+    __m128i jumatati_superioare = _mm_and_si128(_mm_srli_epi32(v, 4), masca_2F);
+    __m128i jumatati_inferioare = _mm_and_si128(v, masca_2F);
+    __m128i superior = _mm_shuffle_epi8(tabel_superior, jumatati_superioare);
+    __m128i inferior = _mm_shuffle_epi8(tabel_inferior, jumatati_inferioare);
+    /* Un caracter este valid doar daca bitii din cele doua tabele nu se intersecteaza. */
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(inferior, superior), _mm_setzero_si128())) != 0)
+        return false;
+    /* '/' are aceeasi jumatate superioara ca '+', deci are nevoie de o deplasare separata. */
+    __m128i este_2F = _mm_cmpeq_epi8(v, masca_2F);
+    v = _mm_add_epi8(v, _mm_shuffle_epi8(tabel_deplasare, _mm_add_epi8(este_2F, jumatati_superioare)));
+
+    /* Cele 4 valori de 6 biti din fiecare grup de 32 de biti sunt lipite in 3 octeti. */
+    __m128i perechi = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    __m128i grupuri = _mm_madd_epi16(perechi, _mm_set1_epi32(0x00011000));
+    grupuri = _mm_shuffle_epi8(grupuri, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    _mm_storeu_si128((__m128i*)destinatie, grupuri);
+    return true;
+}
+#endif
+
+class DecodorCRC32 {
+public:
+    explicit DecodorCRC32(FormatText format) : format(format) {
+        for (int i = 0; i < 256; i++)
+            valori_base64[i] = -1;
+        const char* alfabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i = 0; i < 64; i++)
+            valori_base64[(unsigned char)alfabet[i]] = (signed char)i;
+#if defined(DECODARE_SIMD)
+        are_ssse3 = __builtin_cpu_supports("ssse3");
+#endif
+    }
+
+    /* Intoarce false la primul caracter invalid. */
+    bool actualizare(const char* text, size_t lungime) {
+        for (size_t i = 0; i < lungime;) {
+            if (in_buffer > DIMENSIUNE_DECODARE - 16)
+                goleste();
+#if defined(DECODARE_SIMD)
+            /* Calea SIMD se foloseste doar la granita unui grup complet (fara jumatati de octet sau grupuri base64 incepute). */
+            if (format == format_hex && biti_in_asteptare == 0 && lungime - i >= 32 && decodareHex32(text + i, buffer + in_buffer)) {
+                in_buffer += 16;
+                i += 32;
+                continue;
+            }
+            if (format == format_base64 && are_ssse3 && biti_in_asteptare == 0 && !padding && lungime - i >= 16 && decodareBase64_16(text + i, buffer + in_buffer)) {
+                in_buffer += 12;
+                i += 16;
+                continue;
+            }
+#endif
+            if (!decodareScalara((unsigned char)text[i++]))
+                return false;
+        }
+        return true;
+    }
+
+    /* Intoarce false daca textul s-a terminat in mijlocul unui octet (hex) sau al unui grup (base64). */
+    bool incheie(CRC32& crc) {
+        goleste();
+        crc = flux.valoare();
+        if (format == format_hex)
+            return biti_in_asteptare == 0;
+        return biti_in_asteptare == 0 || padding;
+    }
+
+    uint64_t octetiDecodati() const { return decodati + in_buffer; }
+
+private:
+    bool decodareScalara(unsigned char caracter) {
+        if (caracter == ' ' || caracter == '\n' || caracter == '\r' || caracter == '\t')
+            return true;
+        if (format == format_hex) {
+            int valoare;
+            if (caracter >= '0' && caracter <= '9')
+                valoare = caracter - '0';
+            else if ((caracter | 0x20) >= 'a' && (caracter | 0x20) <= 'f')
+                valoare = (caracter | 0x20) - 'a' + 10;
+            else
+                return false;
+            acumulator = (acumulator << 4) | (uint32_t)valoare;
+            biti_in_asteptare += 4;
+            if (biti_in_asteptare == 8) {
+                buffer[in_buffer++] = (unsigned char)acumulator;
+                acumulator = biti_in_asteptare = 0;
+            }
+            return true;
+        }
+        if (caracter == '=') {
+            /* Padding dupa 2 sau 3 caractere dintr-un grup; bitii ramasi (mai putin de un octet) se ignora si dupa "=" nu mai pot urma date. */
+            if (!padding && biti_in_asteptare != 4 && biti_in_asteptare != 2)
+                return false;
+            padding = true;
+            acumulator = 0;
+            return true;
+        }
+        if (padding || valori_base64[caracter] < 0)
+            return false;
+        acumulator = (acumulator << 6) | (uint32_t)valori_base64[caracter];
+        biti_in_asteptare += 6;
+        if (biti_in_asteptare >= 8) {
+            biti_in_asteptare -= 8;
+            buffer[in_buffer++] = (unsigned char)(acumulator >> biti_in_asteptare);
+            acumulator &= (1u << biti_in_asteptare) - 1;
+        }
+        return true;
+    }
+
+    void goleste() {
+        flux.actualizare(buffer, in_buffer);
+        decodati += in_buffer;
+        in_buffer = 0;
+    }
+
+    FormatText format;
+    FluxCRC32 flux;
+    unsigned char buffer[DIMENSIUNE_DECODARE];
+    size_t in_buffer = 0;
+    uint64_t decodati = 0;
+    uint32_t acumulator = 0;
+    int biti_in_asteptare = 0;
+    bool padding = false;
+    signed char valori_base64[256];
+    bool are_ssse3 = false;
+};
+
+/* CRC32 al continutului decodat dintr-un fisier text hex sau base64, citit pe blocuri de 64 KiB.
+Intoarce false daca fisierul nu poate fi citit sau textul nu este valid in formatul cerut. */
+bool calculCRC32Text(const string& cale, FormatText format, CRC32& crc, uint64_t& octeti) {
+    ifstream fisier(cale, ios::binary);
+    if (!fisier)
+        return false;
+    DecodorCRC32 decodor(format);
+    vector<char> bloc(64 * 1024);
+    while (fisier) {
+        fisier.read(bloc.data(), bloc.size());
+        if (!decodor.actualizare(bloc.data(), (size_t)fisier.gcount()))
+            return false;
+    }
+    octeti = decodor.octetiDecodati();
+    return decodor.incheie(crc);
+}
+
+/* Verificarea sumelor CRC-32 din trailerele gzip (RFC 1952) pentru arhive cu mai multi membri (pigz, bgzip, fisiere concatenate).
+Necesita zlib: compilare cu -DCHECKSUM_ZLIB si legare cu -lz.
+Membrii sunt decomprimati ca deflate brut, deci zlib nu mai calculeaza el insusi CRC-ul; suma se calculeaza cu actualizareCRC32
+pe masura ce iese fiecare bloc decomprimat si se compara cu trailerul (CRC-32 si ISIZE = lungimea modulo 2^32).
+Membrii BGZF (camp extra "BC" cu dimensiunea membrului) pot fi gasiti fara decomprimare si sunt verificati in paralel, pe loturi
+din fereastra de citire; ceilalti membri sunt decomprimati secvential, in flux, oricat de mari ar fi. */
+#if defined(CHECKSUM_ZLIB)
+
+struct MembruGzip {
+    uint64_t deplasare = 0;         /* In fisier. */
+    uint64_t lungime = 0;           /* Comprimat, cu antet si trailer. */
+    uint64_t octeti = 0;            /* Decomprimati. */
+    CRC32 crc_trailer = 0;
+    CRC32 crc_calculat = 0;
+    const char* eroare = nullptr;   /* nullptr pentru un membru valid. */
+};
+
+struct OptiuniGzip {
+    size_t fereastra = 16 * 1024 * 1024;
+    unsigned fire = max(1u, thread::hardware_concurrency());
+    bool detaliat = false;          /* O linie pentru fiecare membru, nu doar pentru cei eronati. */
+};
+
+struct RezumatGzip {
+    uint64_t membri = 0;
+    uint64_t membri_bgzf = 0;
+    uint64_t eronati = 0;
+    uint64_t octeti = 0;
+    bool citire_completa = true;    /* false daca scanarea s-a oprit inainte de sfarsitul fisierului (antet invalid, fisier trunchiat). */
+    double secunde = 0;
+};
+
+#define ANTET_INCOMPLET SIZE_MAX
+
+/* Intoarce lungimea antetului gzip de la "p", 0 daca nu este un antet valid, sau ANTET_INCOMPLET daca nu este intreg in cei "n" octeti.
+dimensiune_bgzf primeste dimensiunea totala a membrului din campul BGZF, sau 0 daca membrul nu este BGZF. */
+size_t antetGzip(const unsigned char* p, size_t n, uint64_t& dimensiune_bgzf) {
+    dimensiune_bgzf = 0;
+    if (n < 10)
+        return ANTET_INCOMPLET;
+    if (p[0] != 0x1F || p[1] != 0x8B || p[2] != 8 || (p[3] & 0xE0))
+        return 0;
+    unsigned char indicatori = p[3];
+    size_t i = 10;
+    if (indicatori & 4) {           /* FEXTRA */
+        if (n < i + 2)
+            return ANTET_INCOMPLET;
+        size_t lungime_extra = p[i] | (p[i + 1] << 8);
+        i += 2;
+        if (n < i + lungime_extra)
+            return ANTET_INCOMPLET;
+        for (size_t j = i; j + 4 <= i + lungime_extra;) {
+            size_t lungime_camp = p[j + 2] | (p[j + 3] << 8);
+            if (p[j] == 'B' && p[j + 1] == 'C' && lungime_camp == 2 && j + 6 <= i + lungime_extra)
+                dimensiune_bgzf = (uint64_t)(p[j + 4] | (p[j + 5] << 8)) + 1;
+            j += 4 + lungime_camp;
+        }
+        i += lungime_extra;
+    }
+    for (int camp = 0; camp < 2; camp++)    /* FNAME, FCOMMENT: siruri terminate cu zero. */
+        if (indicatori & (8 << camp)) {
+            const void* zero = memchr(p + i, 0, n - i);
+            if (!zero)
+                return ANTET_INCOMPLET;
+            i = (const unsigned char*)zero - p + 1;
+        }
+    if (indicatori & 2)             /* FHCRC */
+        i += 2;
+    if (n < i)
+        return ANTET_INCOMPLET;
+    /* Antetul, deflate-ul minim (2 octeti) si trailerul trebuie sa incapa in dimensiunea declarata. */
+    if (dimensiune_bgzf && dimensiune_bgzf < i + 10)
+        return 0;
+    return i;
+}
+
+/* Decomprimare deflate bruta cu CRC-32 calculat din mers; un obiect pe fir, refolosit pentru toti membrii. */
+class InflatorCRC {
+public:
+    InflatorCRC() : iesire(64 * 1024) {
+        memset(&flux, 0, sizeof flux);
+        initializat = inflateInit2(&flux, -15) == Z_OK;
+    }
+    ~InflatorCRC() {
+        if (initializat)
+            inflateEnd(&flux);
+    }
+    InflatorCRC(const InflatorCRC&) = delete;
+    InflatorCRC& operator=(const InflatorCRC&) = delete;
+
+    void reinitializare() {
+        inflateReset(&flux);
+        stare = 0xFFFFFFFF;
+        octeti = 0;
+    }
+
+    /* Intoarce 1 la sfarsitul fluxului deflate, 0 daca mai sunt necesare date, -1 pentru date corupte. "consumat" = octetii de intrare folositi. */
+    int decomprima(const unsigned char* intrare, size_t n, size_t& consumat) {
+        if (!initializat)
+            return -1;
+        uInt disponibil = (uInt)min<size_t>(n, 1u << 30);
+        flux.next_in = (Bytef*)intrare;
+        flux.avail_in = disponibil;
+        int rezultat;
+        do {
+            flux.next_out = iesire.data();
+            flux.avail_out = (uInt)iesire.size();
+            rezultat = inflate(&flux, Z_NO_FLUSH);
+            size_t produs = iesire.size() - flux.avail_out;
+            stare = actualizareCRC32(stare, iesire.data(), produs);
+            octeti += produs;
+        } while (rezultat == Z_OK && (flux.avail_in > 0 || flux.avail_out == 0));
+        consumat = disponibil - flux.avail_in;
+        if (rezultat == Z_STREAM_END)
+            return 1;
+        return rezultat == Z_OK || rezultat == Z_BUF_ERROR ? 0 : -1;
+    }
+
+    CRC32 crc() const { return stare ^ 0xFFFFFFFF; }
+    uint64_t octeti = 0;
+
+private:
+    z_stream flux;
+    vector<unsigned char> iesire;
+    CRC32 stare = 0xFFFFFFFF;
+    bool initializat;
+};
+
+/* Compara CRC-ul si lungimea calculate cu trailerul de 8 octeti de la "trailer". */
+void verificaTrailer(const unsigned char* trailer, const InflatorCRC& inflator, MembruGzip& membru) {
+    membru.octeti = inflator.octeti;
+    membru.crc_calculat = inflator.crc();
+    membru.crc_trailer = citesteLE32(trailer);
+    if (membru.crc_trailer != membru.crc_calculat) {
+        membru.eroare = "CRC diferit de trailer";
+        metrici.nepotriviri.fetch_add(1, memory_order_relaxed);
+    }
+    else if (citesteLE32(trailer + 4) != (uint32_t)inflator.octeti) {
+        membru.eroare = "ISIZE diferit de lungimea decomprimata";
+        metrici.nepotriviri.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+/* Membru aflat intreg in memorie (BGZF): "date" incepe cu antetul, membru.lungime este dimensiunea declarata. */
+void verificaMembruBgzf(const unsigned char* date, size_t lungime_antet, InflatorCRC& inflator, MembruGzip& membru) {
+    inflator.reinitializare();
+    size_t deflate = membru.lungime - lungime_antet - 8, consumat = 0;
+    if (inflator.decomprima(date + lungime_antet, deflate, consumat) != 1)
+        membru.eroare = "date deflate corupte";
+    else if (consumat != deflate)
+        membru.eroare = "lungime BGZF diferita de lungimea fluxului deflate";
+    else
+        verificaTrailer(date + lungime_antet + deflate, inflator, membru);
+}
+
+class VerificatorGzip {
+public:
+    explicit VerificatorGzip(const OptiuniGzip& optiuni) : optiuni(optiuni) {}
+
+    /* Verifica toti membrii din fisier, in ordine. In "raport" se scrie cate o linie pentru fiecare membru eronat
+    (sau pentru fiecare membru, in modul detaliat): "deplasare  crc_trailer  crc_calculat  stare". */
+    RezumatGzip ruleaza(const string& cale, ostream& raport) {
+        RezumatGzip rezumat;
+        auto inceput = chrono::steady_clock::now();
+        fisier.open(cale, ios::binary);
+        if (!fisier) {
+            metrici.erori_citire.fetch_add(1, memory_order_relaxed);
+            rezumat.citire_completa = false;
+            return rezumat;
+        }
+        buffer.resize(max<size_t>(optiuni.fereastra, 1024 * 1024));
+        pozitie = sfarsit = 0;
+        deplasare_buffer = 0;
+        sfarsit_fisier = false;
+        InflatorCRC inflator;
+
+        for (;;) {
+            if (sfarsit - pozitie < buffer.size() / 2)
+                umple();
+            if (pozitie == sfarsit)
+                break;
+
+            /* Lot de membri BGZF aflati intregi in fereastra. */
+            vector<MembruGzip> lot;
+            vector<size_t> antete;
+            for (size_t p = pozitie; p < sfarsit;) {
+                uint64_t dimensiune;
+                size_t antet = antetGzip(buffer.data() + p, sfarsit - p, dimensiune);
+                if (antet == 0 || antet == ANTET_INCOMPLET || dimensiune == 0 || dimensiune > sfarsit - p)
+                    break;
+                MembruGzip membru;
+                membru.deplasare = deplasare_buffer + p;
+                membru.lungime = dimensiune;
+                lot.push_back(membru);
+                antete.push_back(antet);
+                p += dimensiune;
+            }
+            if (!lot.empty()) {
+                verificaLot(lot, antete);
+                for (const MembruGzip& membru : lot)
+                    raporteaza(membru, raport, rezumat);
+                rezumat.membri_bgzf += lot.size();
+                pozitie = lot.back().deplasare + lot.back().lungime - deplasare_buffer;
+                continue;
+            }
+
+            /* Membru obisnuit (sau BGZF mai mare decat restul fisierului): decomprimare in flux. */
+            MembruGzip membru;
+            membru.deplasare = deplasare_buffer + pozitie;
+            uint64_t dimensiune;
+            size_t antet = antetGzip(buffer.data() + pozitie, sfarsit - pozitie, dimensiune);
+            if (antet == ANTET_INCOMPLET && !sfarsit_fisier) {
+                umple();
+                antet = antetGzip(buffer.data() + pozitie, sfarsit - pozitie, dimensiune);
+            }
+            if (antet == 0 || (antet == ANTET_INCOMPLET && sfarsit_fisier)) {
+                membru.eroare = antet ? "fisier trunchiat in antet" : "antet gzip invalid";
+                raporteaza(membru, raport, rezumat);
+                rezumat.citire_completa = false;
+                break;
+            }
+            if (antet == ANTET_INCOMPLET) {
+                /* Antet cu nume sau comentariu mai lung decat fereastra. */
+                membru.eroare = "antet gzip prea lung";
+                raporteaza(membru, raport, rezumat);
+                rezumat.citire_completa = false;
+                break;
+            }
+            pozitie += antet;
+            inflator.reinitializare();
+            int stare;
+            for (;;) {
+                size_t consumat = 0;
+                stare = inflator.decomprima(buffer.data() + pozitie, sfarsit - pozitie, consumat);
+                pozitie += consumat;
+                if (stare != 0 || (sfarsit_fisier && pozitie == sfarsit))
+                    break;
+                umple();
+            }
+            if (stare == 1 && sfarsit - pozitie < 8)
+                umple();
+            if (stare == 1 && sfarsit - pozitie >= 8) {
+                verificaTrailer(buffer.data() + pozitie, inflator, membru);
+                pozitie += 8;
+                membru.lungime = deplasare_buffer + pozitie - membru.deplasare;
+                raporteaza(membru, raport, rezumat);
+                continue;
+            }
+            membru.eroare = stare < 0 ? "date deflate corupte" : "fisier trunchiat";
+            raporteaza(membru, raport, rezumat);
+            rezumat.citire_completa = false;
+            break;
+        }
+
+        fisier.close();
+        metrici.fisiere.fetch_add(1, memory_order_relaxed);
+        rezumat.secunde = chrono::duration<double>(chrono::steady_clock::now() - inceput).count();
+        return rezumat;
+    }
+
+private:
+    /* Muta datele neconsumate la inceputul ferestrei si o completeaza din fisier. */
+    void umple() {
+        if (sfarsit_fisier)
+            return;
+        memmove(buffer.data(), buffer.data() + pozitie, sfarsit - pozitie);
+        deplasare_buffer += pozitie;
+        sfarsit -= pozitie;
+        pozitie = 0;
+        auto inceput = chrono::steady_clock::now();
+        fisier.read((char*)buffer.data() + sfarsit, buffer.size() - sfarsit);
+        metrici.timp_citire_ns.fetch_add(nanosecundeDeLa(inceput), memory_order_relaxed);
+        sfarsit += (size_t)fisier.gcount();
+        if (sfarsit < buffer.size())
+            sfarsit_fisier = true;
+    }
+
+    void verificaLot(vector<MembruGzip>& lot, const vector<size_t>& antete) {
+        atomic<size_t> urmatorul{ 0 };
+        auto lucreaza = [&] {
+            InflatorCRC inflator;
+            for (size_t i; (i = urmatorul.fetch_add(1)) < lot.size();)
+                verificaMembruBgzf(buffer.data() + (lot[i].deplasare - deplasare_buffer), antete[i], inflator, lot[i]);
+        };
+        unsigned numar_fire = (unsigned)min<size_t>(optiuni.fire, lot.size());
+        vector<thread> fire;
+        for (unsigned f = 1; f < numar_fire; f++)
+            fire.emplace_back(lucreaza);
+        lucreaza();
+        for (thread& fir : fire)
+            fir.join();
+    }
+
+    void raporteaza(const MembruGzip& membru, ostream& raport, RezumatGzip& rezumat) {
+        rezumat.membri++;
+        rezumat.octeti += membru.octeti;
+        if (membru.eroare)
+            rezumat.eronati++;
+        if (!membru.eroare && !optiuni.detaliat)
+            return;
+        char linie[64];
+        snprintf(linie, sizeof linie, "%012llx  %08x  %08x  ", (unsigned long long)membru.deplasare, membru.crc_trailer, membru.crc_calculat);
+        raport << linie << (membru.eroare ? membru.eroare : "OK") << "\n";
+    }
+
+    OptiuniGzip optiuni;
+    ifstream fisier;
+    vector<unsigned char> buffer;
+    size_t pozitie = 0, sfarsit = 0;
+    uint64_t deplasare_buffer = 0;
+    bool sfarsit_fisier = false;
+};
+#endif
+
+/* Reluarea unei urme de apeluri (inregistrata din program sau scrisa din alta sursa) pe fiecare kernel.
+Fisierul are cate o linie "algoritm lungime aliniere [repetari]" (ex.: "crc32 1500 8"); liniile care incep cu '#' sunt comentarii.
+Coloana optionala "repetari" permite descrierea unei distributii (histograma) in loc de o urma completa. */
+#define LUNGIME_MAXIMA_URMA (1ull << 30)
+/* Numarul maxim de mesaje al unei urme, dupa aplicarea repetarilor (16 octeti fiecare in memorie). */
+#define MESAJE_MAXIME_URMA (1ull << 24)
+
+bool salveazaUrma(const vector<IntrareUrma>& urma, const string& cale) {
+    ofstream fisier(cale);
+    if (!fisier)
+        return false;
+    fisier << "# urma checksum: algoritm lungime aliniere [repetari]\n";
+    for (const IntrareUrma& intrare : urma)
+        fisier << nume_algoritmi[intrare.algoritm] << " " << intrare.lungime << " " << (int)intrare.aliniere << "\n";
+    return (bool)fisier;
+}
+
+/* Intoarce false si numarul liniei problematice in "linie_eronata" daca fisierul nu poate fi citit sau nu are formatul asteptat. */
+bool incarcaUrma(const string& cale, vector<IntrareUrma>& urma, size_t& linie_eronata) {
+    ifstream fisier(cale);
+    linie_eronata = 0;
+    if (!fisier)
+        return false;
+    string linie;
+    while (getline(fisier, linie)) {
+        linie_eronata++;
+        if (linie.empty() || linie[0] == '#')
+            continue;
+        istringstream campuri(linie);
+        string nume;
+        uint64_t lungime, aliniere, repetari = 1;
+        if (!(campuri >> nume >> lungime >> aliniere))
+            return false;
+        /* Coloana "repetari", daca exista, trebuie sa fie un numar pozitiv, fara nimic dupa el. */
+        if (!(campuri >> ws).eof() && (!(campuri >> repetari) || !(campuri >> ws).eof() || repetari == 0))
+            return false;
+        int algoritm = (int)(find(nume_algoritmi, nume_algoritmi + numar_algoritmi, nume) - nume_algoritmi);
+        if (algoritm == numar_algoritmi || lungime > LUNGIME_MAXIMA_URMA || aliniere > 63 || repetari > MESAJE_MAXIME_URMA - urma.size())
+            return false;
+        urma.insert(urma.end(), repetari, IntrareUrma{ lungime, (uint8_t)algoritm, (uint8_t)aliniere });
+    }
+    return true;
+}
+
+struct OptiuniReluare {
+    unsigned treceri = 3;
+    bool rece = false;  /* Tabelul este scos din cache inainte de fiecare mesaj (apeluri rare, intercalate cu alta activitate). */
+};
+
+/* Timpii unei cai de calcul (un kernel apelat direct, sau alegerea automata prin actualizareCRC). */
+struct RezultatCale {
+    uint64_t mesaje = 0;
+    uint64_t octeti = 0;
+    uint64_t ns = 0;
+    uint64_t mesaje_clasa[numar_clase_dimensiune] = {};
+    uint64_t ns_clasa[numar_clase_dimensiune] = {};
+};
+
+void evacueazaTabel(AlgoritmCRC algoritm) {
+    const unsigned char* tabel;
+    size_t dimensiune;
+    switch (algoritm) {
+    case algoritm_crc32: tabel = (const unsigned char*)tabel_CRC32; dimensiune = sizeof tabel_CRC32; break;
+    case algoritm_crc16: tabel = (const unsigned char*)tabel_CRC16; dimensiune = sizeof tabel_CRC16; break;
+    case algoritm_crc64: tabel = (const unsigned char*)tabel_CRC64; dimensiune = sizeof tabel_CRC64; break;
+    default: tabel = (const unsigned char*)tabel_CRC7; dimensiune = sizeof tabel_CRC7; break;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    for (size_t i = 0; i < dimensiune; i += 64)
+        _mm_clflush(tabel + i);
+    _mm_mfence();
+#else
+    /* Fara o instructiune de evacuare: se parcurge un buffer mai mare decat cache-ul, ceea ce scoate si tabelul. */
+    (void)tabel; (void)dimensiune;
+    static vector<unsigned char> gunoi(64 * 1024 * 1024);
+    for (size_t i = 0; i < gunoi.size(); i += 64)
+        gunoi[i]++;
+#endif
+}
+
+/* Costul minim al unei perechi de citiri ale ceasului; se scade din fiecare masurare. */
+uint64_t costCeas() {
+    uint64_t minim = UINT64_MAX;
+    for (int i = 0; i < 1000; i++) {
+        auto inceput = chrono::steady_clock::now();
+        minim = min<uint64_t>(minim, nanosecundeDeLa(inceput));
+    }
+    return minim;
+}
+
+/* Rezultatele sunt scrise aici, ca apelurile sa nu poata fi eliminate de compilator. */
+volatile uint64_t rezultat_reluare;
+
+/* Fiecare mesaj este masurat separat, ca timpii sa poata fi impartiti pe clase de dimensiune.
+Kernel-ul multibuffer (doar CRC32) primeste mesajele urmei in grupuri de cate NUMAR_BUFFERE, in ordine, si apare doar in total. */
+void reluareUrma(const vector<IntrareUrma>& urma, const OptiuniReluare& optiuni, RezultatCale rezultate[numar_algoritmi][numar_kerneluri + 1]) {
+    uint64_t lungime_maxima = 0;
+    for (const IntrareUrma& intrare : urma)
+        lungime_maxima = max(lungime_maxima, intrare.lungime);
+    vector<unsigned char> buffer(lungime_maxima + 128);
+    mt19937_64 generator(1);
+    for (unsigned char& octet : buffer)
+        octet = (unsigned char)generator();
+    const unsigned char* baza = buffer.data() + (64 - ((uintptr_t)buffer.data() & 63));
+    uint64_t cost = costCeas();
+    uint64_t rezultat_total = 0;
+    vector<const IntrareUrma*> mesaje_crc32;
+    for (const IntrareUrma& intrare : urma)
+        if (intrare.algoritm == algoritm_crc32)
+            mesaje_crc32.push_back(&intrare);
+
+    /* Reluarea nu trebuie sa ajunga in urma pe care poate tocmai o inregistram. */
+    bool inregistrare = urma_apeluri.activa.exchange(false);
+    for (unsigned trecere = 0; trecere < optiuni.treceri; trecere++)
+        for (int cale = 0; cale <= numar_kerneluri; cale++) {
+            if (cale == kernel_multibuffer) {
+                RezultatCale& r = rezultate[algoritm_crc32][kernel_multibuffer];
+                for (size_t g = 0; g < mesaje_crc32.size(); g += NUMAR_BUFFERE) {
+                    size_t in_grup = min<size_t>(NUMAR_BUFFERE, mesaje_crc32.size() - g);
+                    const unsigned char* date[NUMAR_BUFFERE];
+                    size_t lungimi[NUMAR_BUFFERE];
+                    CRC32 stari[NUMAR_BUFFERE];
+                    for (size_t b = 0; b < NUMAR_BUFFERE; b++) {
+                        date[b] = baza + (b < in_grup ? mesaje_crc32[g + b]->aliniere : 0);
+                        lungimi[b] = b < in_grup ? mesaje_crc32[g + b]->lungime : 0;
+                        stari[b] = 0xFFFFFFFF;
+                        r.octeti += lungimi[b];
+                    }
+                    if (optiuni.rece)
+                        evacueazaTabel(algoritm_crc32);
+                    auto inceput = chrono::steady_clock::now();
+                    kernelMultiBufferCRC32(date, lungimi, stari);
+                    uint64_t ns = nanosecundeDeLa(inceput);
+                    r.ns += ns > cost ? ns - cost : 0;
+                    r.mesaje += in_grup;
+                    rezultat_total += stari[0];
+                }
+                continue;
+            }
+            for (const IntrareUrma& intrare : urma) {
+                AlgoritmCRC algoritm = (AlgoritmCRC)intrare.algoritm;
+                if (cale != CALE_DISPECER && !kernelDisponibil(algoritm, (KernelCRC)cale))
+                    continue;
+                const unsigned char* date = baza + intrare.aliniere;
+                if (optiuni.rece)
+                    evacueazaTabel(algoritm);
+                auto inceput = chrono::steady_clock::now();
+                rezultat_total += cale == CALE_DISPECER ? actualizareCuDispecer(algoritm, stareInitiala(algoritm), date, intrare.lungime)
+                    : actualizareCuKernel(algoritm, (KernelCRC)cale, stareInitiala(algoritm), date, intrare.lungime);
+                uint64_t ns = nanosecundeDeLa(inceput);
+                ns = ns > cost ? ns - cost : 0;
+                RezultatCale& r = rezultate[algoritm][cale];
+                ClasaDimensiune clasa = clasaDimensiune(intrare.lungime);
+                r.mesaje++;
+                r.octeti += intrare.lungime;
+                r.ns += ns;
+                r.mesaje_clasa[clasa]++;
+                r.ns_clasa[clasa] += ns;
+            }
+        }
+    urma_apeluri.activa.store(inregistrare);
+    rezultat_reluare = rezultat_total;
+}
+
+void afisareReluare(const RezultatCale rezultate[numar_algoritmi][numar_kerneluri + 1], ostream& iesire) {
+    for (int algoritm = 0; algoritm < numar_algoritmi; algoritm++) {
+        if (!rezultate[algoritm][CALE_DISPECER].mesaje)
+            continue;
+        iesire << nume_algoritmi[algoritm] << ":" << endl;
+        for (int cale = 0; cale <= numar_kerneluri; cale++) {
+            const RezultatCale& r = rezultate[algoritm][cale];
+            if (!r.mesaje)
+                continue;
+            iesire << "  " << (cale == CALE_DISPECER ? "dispecer" : nume_kerneluri[cale]) << ": " << r.mesaje << " mesaje, "
+                << (double)r.ns / r.mesaje << " ns/mesaj, " << (r.ns ? (double)r.octeti / r.ns : 0) << " GB/s" << endl;
+        }
+        for (int clasa = 0; clasa < numar_clase_dimensiune; clasa++) {
+            const RezultatCale& dispecer = rezultate[algoritm][CALE_DISPECER];
+            if (!dispecer.mesaje_clasa[clasa])
+                continue;
+            iesire << "    " << nume_clase_dimensiune[clasa] << " (" << dispecer.mesaje_clasa[clasa] << " mesaje):";
+            for (int cale = 0; cale <= numar_kerneluri; cale++) {
+                const RezultatCale& r = rezultate[algoritm][cale];
+                if (r.mesaje_clasa[clasa])
+                    iesire << " " << (cale == CALE_DISPECER ? "dispecer" : nume_kerneluri[cale]) << " " << (double)r.ns_clasa[clasa] / r.mesaje_clasa[clasa] << " ns";
+            }
+            iesire << endl;
+        }
+    }
+}
+
+/* Interfata compatibila cu zlib: crc32, crc32_z, crc32_combine (si variantele lor), calculate cu kernel-urile de aici.
+CRC-32/ISO-HDLC din calculCRC32 este exact suma de control din zlib (polinomul reflectat 0xEDB88320, valoare initiala si XOR final 0xFFFFFFFF),
+deci functiile pot inlocui direct pe cele din zlib.
+
+crc32 si crc32_z nu trec prin dispecerul actualizareCRC32 (metrici, histograme, urma, sonde), ci direct prin actualizareRapidaCRC32,
+ca un program gazda cu multe fire sa nu scrie la fiecare apel in contoarele comune.
+
+Biblioteca pentru LD_PRELOAD (programele existente folosesc implementarea de aici fara recompilare):
+    g++ -std=c++17 -O2 -fPIC -shared -fvisibility=hidden -pthread -DCHECKSUM_BIBLIOTECA -DCHECKSUM_ZLIB_ABI checksum.cpp -o libchecksum_zlib.so
+    LD_PRELOAD=./libchecksum_zlib.so program ...
+Compilat ca program (fara -DCHECKSUM_BIBLIOTECA), testul diferential compara in plus aceste functii cu libz din sistem.
+Sunt inlocuite doar apelurile facute prin tabela de simboluri dinamica: zlib legat static, sau apelurile interne din libz
+(ex.: verificarea trailerului in inflate), raman la implementarea din zlib.
+Tabelele se initializeaza la primul apel, deci biblioteca nu cere un pas de initializare din partea programului. */
+#if defined(CHECKSUM_ZLIB_ABI)
+
+#if !defined(CHECKSUM_ZLIB)
+/* Tipurile din zconf.h, pentru compilarea fara zlib.h. */
+typedef long z_off_t;
+typedef int64_t z_off64_t;
+typedef uint32_t z_crc_t;
+#endif
+
+#if defined(_WIN32)
+#define EXPORT_ZLIB extern "C" __declspec(dllexport)
+#else
+#define EXPORT_ZLIB extern "C" __attribute__((visibility("default")))
+#endif
+
+EXPORT_ZLIB unsigned long crc32_z(unsigned long crc, const unsigned char* buf, size_t len) {
+    if (!buf)
+        return 0;   /* Ca in zlib: crc32(0, NULL, 0) da valoarea initiala. */
+    initializare_tabele();
+    return actualizareRapidaCRC32((CRC32)crc ^ 0xFFFFFFFF, buf, len) ^ 0xFFFFFFFF;
+}
+
+EXPORT_ZLIB unsigned long crc32(unsigned long crc, const unsigned char* buf, unsigned int len) {
+    return crc32_z(crc, buf, len);
+}
+
+EXPORT_ZLIB unsigned long crc32_combine64(unsigned long crc1, unsigned long crc2, z_off64_t len2) {
+    if (len2 < 0)
+        return crc1;
+    return combinaCRC32((CRC32)crc1, (CRC32)crc2, (uint64_t)len2);
+}
+
+EXPORT_ZLIB unsigned long crc32_combine(unsigned long crc1, unsigned long crc2, z_off_t len2) {
+    return crc32_combine64(crc1, crc2, len2);
+}
+
+/* Combinarea in doi pasi din zlib 1.2.12: operatorul x^(8*len2) mod P se calculeaza o data si se aplica apoi oricator perechi. */
+EXPORT_ZLIB unsigned long crc32_combine_gen64(z_off64_t len2) {
+    return putereX8n<CRC32, polinomCRC32>(len2 < 0 ? 0 : (uint64_t)len2);
+}
+
+EXPORT_ZLIB unsigned long crc32_combine_gen(z_off_t len2) {
+    return crc32_combine_gen64(len2);
+}
+
+EXPORT_ZLIB unsigned long crc32_combine_op(unsigned long crc1, unsigned long crc2, unsigned long op) {
+    return inmultireModP<CRC32>((CRC32)op, (CRC32)crc1, polinomCRC32) ^ (CRC32)crc2;
+}
+
+EXPORT_ZLIB const z_crc_t* get_crc_table(void) {
+    initializare_tabele();
+    return (const z_crc_t*)tabel_CRC32;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+/* Compara interfata de aici cu zlib-ul sistemului, incarcat cu dlopen: simbolurile cautate prin dlsym pe biblioteca incarcata
+sunt cele din libz, nu cele exportate mai sus. Se verifica buf == NULL, lungimi in jurul pragurilor de alegere a kernel-ului,
+alinieri si valori initiale aleatoare, si combinarea pe taieturi aleatoare, inclusiv len2 == 0.
+len2 < 0 nu este trimis la zlib (de la 1.2.12 calculul puterii nu se mai termina pentru o lungime negativa);
+aici rezultatul este crc1, ca in zlib 1.2.11. Fara libz in sistem comparatia este sarita. */
+int verificareZlibABI(uint64_t samanta, ostream& raport) {
+    typedef unsigned long (*FunctieCRC32)(unsigned long, const unsigned char*, unsigned int);
+    typedef unsigned long (*FunctieCRC32Z)(unsigned long, const unsigned char*, size_t);
+    typedef unsigned long (*FunctieCombinare)(unsigned long, unsigned long, z_off_t);
+#if defined(__APPLE__)
+    void* zlib = dlopen("libz.dylib", RTLD_NOW | RTLD_LOCAL);
+#else
+    void* zlib = dlopen("libz.so.1", RTLD_NOW | RTLD_LOCAL);
+#endif
+    if (!zlib) {
+        raport << "zlib nu a fost gasita; comparatia interfetei zlib a fost sarita." << endl;
+        return 0;
+    }
+    FunctieCRC32 zlib_crc32 = (FunctieCRC32)dlsym(zlib, "crc32");
+    FunctieCRC32Z zlib_crc32_z = (FunctieCRC32Z)dlsym(zlib, "crc32_z");    /* Exista de la zlib 1.2.9. */
+    FunctieCombinare zlib_combinare = (FunctieCombinare)dlsym(zlib, "crc32_combine");
+    if (!zlib_crc32 || !zlib_combinare) {
+        raport << "zlib nu exporta crc32 / crc32_combine; comparatia interfetei zlib a fost sarita." << endl;
+        dlclose(zlib);
+        return 0;
+    }
+
+    int nepotriviri = 0;
+    auto compara = [&](const char* functie, unsigned long aici, unsigned long in_zlib, uint64_t lungime) {
+        if (aici == in_zlib)
+            return;
+        nepotriviri++;
+        raport << "interfata zlib / " << functie << ": lungime " << dec << lungime << ", rezultat " << hex << aici << ", zlib " << in_zlib << dec << endl;
+    };
+    for (unsigned long crc : { 0ul, 0x12345678ul, 0xFFFFFFFFul })
+        for (unsigned lungime : { 0u, 5u }) {
+            compara("crc32(NULL)", crc32(crc, nullptr, lungime), zlib_crc32(crc, nullptr, lungime), lungime);
+            if (zlib_crc32_z)
+                compara("crc32_z(NULL)", crc32_z(crc, nullptr, lungime), zlib_crc32_z(crc, nullptr, lungime), lungime);
+        }
+
+    mt19937_64 generator(samanta);
+    vector<unsigned char> buffer(PRAG_MASIV + 64);
+    for (unsigned char& octet : buffer)
+        octet = (unsigned char)generator();
+    const size_t lungimi_prag[] = { 1, 15, 16, PRAG_PLIERE - 1, PRAG_PLIERE, PRAG_PLIERE + 15, PRAG_INTERCALARE - 1, PRAG_INTERCALARE, PRAG_MASIV };
+    for (int i = 0; i < 400 && nepotriviri < 10; i++) {
+        size_t lungime = i < (int)(sizeof lungimi_prag / sizeof lungimi_prag[0]) ? lungimi_prag[i] : i % 4 == 0 ? generator() % PRAG_MASIV : generator() % 4096;
+        const unsigned char* date = buffer.data() + generator() % 64;
+        unsigned long initial = i % 2 ? (unsigned long)(generator() & 0xFFFFFFFF) : 0;
+        compara("crc32", crc32(initial, date, (unsigned)lungime), zlib_crc32(initial, date, (unsigned)lungime), lungime);
+        if (zlib_crc32_z)
+            compara("crc32_z", crc32_z(initial, date, lungime), zlib_crc32_z(initial, date, lungime), lungime);
+
+        size_t taietura = lungime ? generator() % (lungime + 1) : 0;
+        unsigned long crc1 = zlib_crc32(0, date, (unsigned)taietura), crc2 = zlib_crc32(0, date + taietura, (unsigned)(lungime - taietura));
+        compara("crc32_combine", crc32_combine(crc1, crc2, (z_off_t)(lungime - taietura)), zlib_combinare(crc1, crc2, (z_off_t)(lungime - taietura)), lungime);
+        compara("crc32_combine(len2 = 0)", crc32_combine(crc1, 0, 0), zlib_combinare(crc1, 0, 0), 0);
+        compara("crc32_combine(len2 < 0)", crc32_combine(crc1, crc2, -(z_off_t)(taietura + 1)), crc1, 0);
+    }
+    dlclose(zlib);
+    return nepotriviri;
+}
+#endif
+#endif
+
+/* Debitul motorului unui model pe 16 MiB, pe calea cu pliere si pe calea cu tabel. */
+void comparatieMotor(const MotorCRC& motor, ostream& iesire) {
+    vector<unsigned char> date(16 * 1024 * 1024);
+    mt19937_64 generator(1);
+    for (unsigned char& octet : date)
+        octet = (unsigned char)generator();
+    for (int cale = 0; cale < 2; cale++) {
+        if (cale == 0 && !motor.arePliere()) {
+            iesire << "  pliere PCLMUL: indisponibila pe acest procesor" << endl;
+            continue;
+        }
+        auto inceput = chrono::steady_clock::now();
+        uint64_t stare = cale == 0 ? motor.actualizare(motor.stareInitiala(), date.data(), date.size())
+            : motor.actualizareTabel(motor.stareInitiala(), date.data(), date.size());
+        double secunde = chrono::duration<double>(chrono::steady_clock::now() - inceput).count();
+        iesire << "  " << (cale == 0 ? "pliere PCLMUL" : "tabel") << ": " << hex << motor.finalizare(stare) << dec << ", "
+            << date.size() / secunde / 1e9 << " GB/s" << endl;
+    }
+}
+
+/* Verificare in fundal, cu consum limitat, a unui manifest "crc  cale" (formatul scris de ConductaCRC).
+Limitele sunt un debit (octeti/s, galeata cu jetoane) si o cota de procesor (fractiunea din timp in care firul lucreaza:
+dupa un bloc care a durat t, firul doarme t * (1 / cota - 1)). Pe Linux ambele limite se adapteaza la incarcarea sistemului
+citita din /proc/pressure (PSI): cand procentul de timp in care alte sarcini asteapta procesorul sau discul depaseste pragul,
+factorul de viteza se injumatateste; cand presiunea scade, el creste inapoi treptat (AIMD, ca la controlul congestiei in TCP). */
+
+struct OptiuniFundal {
+    uint64_t octeti_pe_secunda = 64ull * 1024 * 1024;   /* 0 = fara limita de debit. */
+    double cota_procesor = 0.25;                        /* Din timpul unui nucleu, intre 0 si 1. */
+    double prag_presiune = 10.0;                        /* Procent "some avg10" din PSI; 0 = fara adaptare. */
+    size_t dimensiune_bloc = 1024 * 1024;
+};
+
+/* Debitul se masoara pe o galeata cu jetoane; un bloc mai mare decat galeata lasa o datorie, platita cu o pauza mai lunga. */
+class GaleataJetoane {
+public:
+    explicit GaleataJetoane(double capacitate) : capacitate(capacitate), jetoane(capacitate), ultima(chrono::steady_clock::now()) {}
+
+    /* Consuma "numar" jetoane la rata data si intoarce cat trebuie asteptat pana cand datoria este platita. */
+    chrono::nanoseconds consuma(double numar, double rata) {
+        auto acum = chrono::steady_clock::now();
+        jetoane = min(capacitate, jetoane + chrono::duration<double>(acum - ultima).count() * rata);
+        ultima = acum;
+        jetoane -= numar;
+        if (jetoane >= 0 || rata <= 0)
+            return chrono::nanoseconds(0);
+        return chrono::nanoseconds((int64_t)(-jetoane / rata * 1e9));
+    }
+
+private:
+    double capacitate;
+    double jetoane;
+    chrono::steady_clock::time_point ultima;
+};
+
+/* Valoarea "some avg10" dintr-un fisier PSI (ex.: /proc/pressure/cpu). */
+bool citestePresiune(const char* cale, double& avg10) {
+    ifstream fisier(cale);
+    string linie;
+    while (getline(fisier, linie))
+        if (linie.compare(0, 5, "some ") == 0) {
+            size_t pozitie = linie.find("avg10=");
+            if (pozitie == string::npos)
+                return false;
+            avg10 = atof(linie.c_str() + pozitie + 6);
+            return true;
+        }
+    return false;
+}
+
+class VerificareFundal {
+public:
+    ~VerificareFundal() { opreste(); }
+
+    /* Porneste verificarea pe un fir separat. Intoarce false daca o verificare ruleaza deja sau fisierele nu pot fi deschise. */
+    bool porneste(const string& cale_manifest, const string& cale_raport, const OptiuniFundal& optiuni_date) {
+        if (activa.load())
+            return false;
+        if (fir.joinable())
+            fir.join();
+        manifest.close();
+        manifest.clear();
+        manifest.open(cale_manifest);
+        raport.close();
+        raport.clear();
+        raport.open(cale_raport);
+        if (!manifest || !raport)
+            return false;
+        optiuni = optiuni_date;
+        for (atomic<uint64_t>* contor : { &fisiere, &octeti, &nepotriviri, &erori })
+            contor->store(0);
+        factor_promile.store(1000);
+        presiune_sutimi.store(-1);
+        oprire = false;
+        pornita = true;
+        activa.store(true);
+        fir = thread([this] { ruleaza(); });
+        return true;
+    }
+
+    void opreste() {
+        {
+            lock_guard<mutex> blocare(m);
+            oprire = true;
+        }
+        cv.notify_all();
+        if (fir.joinable())
+            fir.join();
+    }
+
+    void afiseazaStare(ostream& iesire) const {
+        if (!pornita) {
+            iesire << "Nicio verificare in fundal nu a fost pornita." << endl;
+            return;
+        }
+        iesire << (activa.load() ? "Verificarea in fundal ruleaza: " : "Verificarea in fundal s-a oprit: ") << fisiere.load() << " fisiere, "
+            << octeti.load() / (1024 * 1024) << " MB, " << nepotriviri.load() << " nepotriviri, " << erori.load() << " erori de citire; "
+            << "factor de viteza " << factor_promile.load() / 10.0 << "%";
+        int presiune = presiune_sutimi.load();
+        if (presiune >= 0)
+            iesire << ", presiune PSI " << presiune / 100.0 << "%";
+        else
+            iesire << ", PSI indisponibil";
+        iesire << "." << endl;
+    }
+
+    bool esteActiva() const { return activa.load(); }
+
+private:
+    void ruleaza() {
+        vector<char> buffer(optiuni.dimensiune_bloc);
+        GaleataJetoane galeata((double)optiuni.dimensiune_bloc);
+        auto ultima_presiune = chrono::steady_clock::now() - chrono::seconds(1);
+        double factor = 1.0;
+        string linie;
+        while (!oprit() && getline(manifest, linie)) {
+            if (!linie.empty() && linie.back() == '\r')
+                linie.pop_back();
+            /* Liniile "EROARE  cale" (fisiere care nu au putut fi citite la scrierea manifestului) nu au un cod de verificat. */
+            if (linie.size() < 11 || linie.compare(8, 2, "  ") != 0 || linie.find_first_not_of("0123456789abcdefABCDEF") < 8)
+                continue;
+            CRC32 asteptat = (CRC32)strtoul(linie.substr(0, 8).c_str(), nullptr, 16);
+            string cale = linie.substr(10);
+            ifstream fisier(cale, ios::binary);
+            CRC32 stare = 0xFFFFFFFF;
+            while (fisier && !oprit()) {
+                auto inceput = chrono::steady_clock::now();
+                fisier.read(buffer.data(), buffer.size());
+                size_t citit = (size_t)fisier.gcount();
+                stare = actualizareCRC32(stare, (const unsigned char*)buffer.data(), citit);
+                octeti.fetch_add(citit);
+                chrono::nanoseconds lucru = chrono::steady_clock::now() - inceput;
+
+                if (optiuni.prag_presiune > 0 && chrono::steady_clock::now() - ultima_presiune >= chrono::seconds(1)) {
+                    ultima_presiune = chrono::steady_clock::now();
+                    factor = adaptareFactor(factor);
+                }
+                chrono::nanoseconds pauza(0);
+                if (optiuni.octeti_pe_secunda)
+                    pauza = galeata.consuma((double)citit, optiuni.octeti_pe_secunda * factor);
+                double cota = max(0.01, min(1.0, optiuni.cota_procesor * factor));
+                pauza = max(pauza, chrono::nanoseconds((int64_t)(lucru.count() * (1 / cota - 1))));
+                if (pauza.count() > 0) {
+                    unique_lock<mutex> blocare(m);
+                    cv.wait_for(blocare, pauza, [this] { return oprire; });
+                }
+            }
+            if (oprit())
+                break;
+            char coduri[32];
+            if (fisier.bad() || !fisier.eof()) {
+                erori.fetch_add(1);
+                metrici.erori_citire.fetch_add(1, memory_order_relaxed);
+                raport << "EROARE  " << cale << endl;
+            }
+            else if ((stare ^ 0xFFFFFFFF) != asteptat) {
+                nepotriviri.fetch_add(1);
+                metrici.nepotriviri.fetch_add(1, memory_order_relaxed);
+                snprintf(coduri, sizeof coduri, "%08x  %08x  ", (unsigned)asteptat, (unsigned)(stare ^ 0xFFFFFFFF));
+                raport << "NEPOTRIVIRE  " << coduri << cale << endl;
+            }
+            fisiere.fetch_add(1);
+            metrici.fisiere.fetch_add(1, memory_order_relaxed);
+        }
+        raport.flush();
+        activa.store(false);
+    }
+
+    /* AIMD: injumatatire peste prag (pana la 1/64), altfel crestere cu 10 puncte procentuale. */
+    double adaptareFactor(double factor) {
+        double cpu = 0, io = 0;
+        bool are_cpu = citestePresiune("/proc/pressure/cpu", cpu);
+        bool are_io = citestePresiune("/proc/pressure/io", io);
+        if (!are_cpu && !are_io) {
+            presiune_sutimi.store(-1);
+            return factor;
+        }
+        double presiune = max(cpu, io);
+        presiune_sutimi.store((int)(presiune * 100));
+        factor = presiune > optiuni.prag_presiune ? max(1.0 / 64, factor / 2) : min(1.0, factor + 0.1);
+        factor_promile.store((int)(factor * 1000));
+        return factor;
+    }
+
+    bool oprit() {
+        lock_guard<mutex> blocare(m);
+        return oprire;
+    }
+
+    OptiuniFundal optiuni;
+    ifstream manifest;
+    ofstream raport;
+    thread fir;
+    mutex m;
+    condition_variable cv;
+    bool oprire = false;
+    bool pornita = false;
+    atomic<bool> activa{ false };
+    atomic<uint64_t> fisiere{ 0 }, octeti{ 0 }, nepotriviri{ 0 }, erori{ 0 };
+    atomic<int> factor_promile{ 1000 };
+    atomic<int> presiune_sutimi{ -1 };
+};
+
+VerificareFundal& verificareFundal() {
+    static VerificareFundal verificare;
+    return verificare;
+}
+
+/* Index de blocuri: CRC32 pentru fiecare bloc de dimensiune fixa din fiecare fisier al unui director, pentru verificarea
+prin esantionare (si pentru orice alta comparatie care are nevoie de coduri pe portiuni ale fisierelor).
+Fisierul de index incepe cu un antet de 16 octeti: "CRCIDX01", dimensiunea blocului si 4 octeti rezervati. Urmeaza cate o
+intrare pentru fiecare fisier: lungimea caii, calea (relativa la radacina indexata, cu '/'), lungimea fisierului (64 de biti),
+CRC32 al fisierului intreg, CRC32 al fiecarui bloc si, la final, CRC32 al intrarii, ca un index deteriorat sa fie recunoscut.
+Toate numerele sunt little-endian. */
+
+#define DIMENSIUNE_ANTET_INDEX 16
+
+struct FisierIndexat {
+    string cale;
+    uint64_t lungime = 0;
+    CRC32 crc = 0;
+    vector<CRC32> blocuri;
+};
+
+struct IndexCRC {
+    uint32_t dimensiune_bloc = 1024 * 1024;
+    vector<FisierIndexat> fisiere;
+};
+
+/* Calculeaza intrarea pentru un fisier; CRC-ul intreg se obtine prin combinarea codurilor blocurilor. */
+bool indexeazaFisier(const string& cale, uint32_t dimensiune_bloc, FisierIndexat& intrare) {
+    ifstream fisier(cale, ios::binary);
+    if (!fisier)
+        return false;
+    vector<char> buffer(dimensiune_bloc);
+    intrare.lungime = 0;
+    intrare.blocuri.clear();
+    for (;;) {
+        fisier.read(buffer.data(), buffer.size());
+        size_t citit = (size_t)fisier.gcount();
+        if (!citit)
+            break;
+        CRC32 crc = actualizareCRC32(0xFFFFFFFF, (const unsigned char*)buffer.data(), citit) ^ 0xFFFFFFFF;
+        intrare.crc = intrare.blocuri.empty() ? crc : combinaCRC32(intrare.crc, crc, citit);
+        intrare.blocuri.push_back(crc);
+        intrare.lungime += citit;
+    }
+    if (intrare.blocuri.empty())
+        intrare.crc = 0;
+    return !fisier.bad();
+}
+
+/* Indexeaza un fisier sau toate fisierele unui director; "erori" numara fisierele care nu au putut fi citite. */
+IndexCRC construiesteIndex(const string& cale, uint32_t dimensiune_bloc, uint64_t& erori) {
+    IndexCRC index;
+    index.dimensiune_bloc = dimensiune_bloc;
+    erori = 0;
+    error_code eroare;
+    filesystem::path radacina = filesystem::is_directory(cale, eroare) ? filesystem::path(cale) : filesystem::path(cale).parent_path();
+    parcurgeFisiere(cale, [&](const string& cale_fisier) {
+        FisierIndexat intrare;
+        if (!indexeazaFisier(cale_fisier, dimensiune_bloc, intrare)) {
+            erori++;
+            metrici.erori_citire.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        intrare.cale = filesystem::path(cale_fisier).lexically_relative(radacina).generic_string();
+        index.fisiere.push_back(move(intrare));
+        metrici.fisiere.fetch_add(1, memory_order_relaxed);
+    });
+    return index;
+}
+
+bool scrieIndex(const IndexCRC& index, const string& cale) {
+    ofstream fisier(cale, ios::binary);
+    unsigned char antet[DIMENSIUNE_ANTET_INDEX] = { 'C', 'R', 'C', 'I', 'D', 'X', '0', '1' };
+    scrieLE32(antet + 8, index.dimensiune_bloc);
+    fisier.write((const char*)antet, sizeof antet);
+    vector<unsigned char> intrare;
+    for (const FisierIndexat& f : index.fisiere) {
+        intrare.assign(4 + f.cale.size() + 12 + 4 * f.blocuri.size() + 4, 0);
+        unsigned char* p = intrare.data();
+        scrieLE32(p, (uint32_t)f.cale.size());
+        memcpy(p + 4, f.cale.data(), f.cale.size());
+        p += 4 + f.cale.size();
+        scrieLE32(p, (uint32_t)f.lungime);
+        scrieLE32(p + 4, (uint32_t)(f.lungime >> 32));
+        scrieLE32(p + 8, f.crc);
+        p += 12;
+        for (CRC32 crc : f.blocuri) {
+            scrieLE32(p, crc);
+            p += 4;
+        }
+        scrieLE32(p, actualizareCRC32(0xFFFFFFFF, intrare.data(), (size_t)(p - intrare.data())) ^ 0xFFFFFFFF);
+        fisier.write((const char*)intrare.data(), intrare.size());
+    }
+    return (bool)fisier;
+}
+
+/* Intoarce false cu o descriere in "eroare" daca fisierul lipseste, nu este un index sau are o intrare deteriorata. */
+bool citesteIndex(const string& cale, IndexCRC& index, string& eroare) {
+    string continut;
+    if (!citireFisier(cale, continut)) {
+        eroare = "fisierul nu poate fi citit";
+        return false;
+    }
+    const unsigned char* date = (const unsigned char*)continut.data();
+    if (continut.size() < DIMENSIUNE_ANTET_INDEX || continut.compare(0, 8, "CRCIDX01") != 0 || citesteLE32(date + 8) == 0) {
+        eroare = "antet de index invalid";
+        return false;
+    }
+    index.dimensiune_bloc = citesteLE32(date + 8);
+    index.fisiere.clear();
+    for (size_t p = DIMENSIUNE_ANTET_INDEX; p < continut.size();) {
+        size_t ramas = continut.size() - p;
+        uint32_t lungime_cale = ramas >= 4 ? citesteLE32(date + p) : 0;
+        if (ramas < 4 || ramas - 4 < (uint64_t)lungime_cale + 12) {
+            eroare = "intrare trunchiata la deplasarea " + to_string(p);
+            return false;
+        }
+        FisierIndexat f;
+        f.cale.assign(continut, p + 4, lungime_cale);
+        const unsigned char* q = date + p + 4 + lungime_cale;
+        f.lungime = citesteLE32(q) | (uint64_t)citesteLE32(q + 4) << 32;
+        f.crc = citesteLE32(q + 8);
+        uint64_t numar_blocuri = (f.lungime + index.dimensiune_bloc - 1) / index.dimensiune_bloc;
+        uint64_t lungime_intrare = 4 + (uint64_t)lungime_cale + 12 + 4 * numar_blocuri + 4;
+        if (ramas < lungime_intrare) {
+            eroare = "intrare trunchiata la deplasarea " + to_string(p);
+            return false;
+        }
+        if (actualizareCRC32(0xFFFFFFFF, date + p, (size_t)lungime_intrare - 4) ^ 0xFFFFFFFF ^ citesteLE32(date + p + lungime_intrare - 4)) {
+            eroare = "intrare deteriorata (CRC diferit) pentru " + f.cale;
+            return false;
+        }
+        for (uint64_t b = 0; b < numar_blocuri; b++)
+            f.blocuri.push_back(citesteLE32(q + 12 + 4 * b));
+        index.fisiere.push_back(move(f));
+        p += (size_t)lungime_intrare;
+    }
+    return true;
+}
+
+/* Verificarea prin esantionare: din fiecare fisier se citesc doar blocurile alese aleator (fiecare bloc cu probabilitatea
+"fractie"), cu un generator initializat din samanta si din CRC-64 al caii, deci aceeasi samanta alege aceleasi blocuri
+indiferent de ordinea fisierelor sau de numarul de fire. Blocurile alese se citesc in ordinea deplasarii. */
+
+struct OptiuniEsantionare {
+    double fractie = 0.01;
+    uint64_t samanta = 1;
+    unsigned fire = max(1u, thread::hardware_concurrency());
+};
+
+struct RezultatEsantionare {
+    uint64_t fisiere = 0;
+    uint64_t blocuri_total = 0;
+    uint64_t esantionate = 0;
+    uint64_t corupte = 0;
+    uint64_t fisiere_lipsa = 0;
+    uint64_t fisiere_modificate = 0;    /* Lungime diferita de cea din index. */
+    double secunde = 0;
+};
+
+/* Numarul de blocuri esantionate dintr-un fisier cu n blocuri: fractie * n rotunjit aleator, ca media sa fie exact fractie * n. */
+vector<uint64_t> alegeBlocuri(uint64_t n, double fractie, mt19937_64& generator) {
+    double asteptat = fractie * n;
+    uint64_t k = (uint64_t)asteptat;
+    if (uniform_real_distribution<double>(0, 1)(generator) < asteptat - k)
+        k++;
+    k = min(k, n);
+    /* Algoritmul lui Floyd: k indici distincti din [0, n), cu exact k extrageri. Testul de apartenenta se face in multime,
+    ca esantioanele mari (sute de mii de blocuri) sa coste O(k), nu O(k^2). */
+    unordered_set<uint64_t> multime;
+    multime.reserve((size_t)k);
+    for (uint64_t j = n - k; j < n; j++) {
+        uint64_t t = uniform_int_distribution<uint64_t>(0, j)(generator);
+        multime.insert(multime.count(t) ? j : t);
+    }
+    vector<uint64_t> alese(multime.begin(), multime.end());
+    sort(alese.begin(), alese.end());
+    return alese;
+}
+
+RezultatEsantionare verificareEsantion(const IndexCRC& index, const string& radacina, const OptiuniEsantionare& optiuni, ostream& raport) {
+    RezultatEsantionare total;
+    mutex m;
+    atomic<size_t> urmatorul{ 0 };
+    auto inceput = chrono::steady_clock::now();
+    auto lucreaza = [&] {
+        RezultatEsantionare partial;
+        vector<char> buffer(index.dimensiune_bloc);
+        ostringstream linii;
+        for (size_t i; (i = urmatorul.fetch_add(1)) < index.fisiere.size();) {
+            const FisierIndexat& f = index.fisiere[i];
+            partial.fisiere++;
+            partial.blocuri_total += f.blocuri.size();
+            string cale = (filesystem::path(radacina) / f.cale).string();
+            ifstream fisier(cale, ios::binary);
+            error_code eroare;
+            if (!fisier) {
+                partial.fisiere_lipsa++;
+                linii << "LIPSA  " << cale << "\n";
+                continue;
+            }
+            uint64_t lungime = filesystem::file_size(cale, eroare);
+            if (eroare || lungime != f.lungime) {
+                partial.fisiere_modificate++;
+                linii << "LUNGIME  " << cale << "\n";
+                continue;
+            }
+            mt19937_64 generator(optiuni.samanta ^ calculCRC64(f.cale));
+            for (uint64_t bloc : alegeBlocuri(f.blocuri.size(), optiuni.fractie, generator)) {
+                uint64_t deplasare = bloc * index.dimensiune_bloc;
+                size_t dimensiune = (size_t)min<uint64_t>(index.dimensiune_bloc, f.lungime - deplasare);
+                fisier.seekg((streamoff)deplasare);
+                fisier.read(buffer.data(), dimensiune);
+                partial.esantionate++;
+                CRC32 crc = actualizareCRC32(0xFFFFFFFF, (const unsigned char*)buffer.data(), (size_t)fisier.gcount()) ^ 0xFFFFFFFF;
+                if ((size_t)fisier.gcount() != dimensiune || crc != f.blocuri[bloc]) {
+                    partial.corupte++;
+                    metrici.nepotriviri.fetch_add(1, memory_order_relaxed);
+                    linii << "CORUPT  " << cale << "  bloc " << bloc << "\n";
+                    fisier.clear();
+                }
+            }
+        }
+        lock_guard<mutex> blocare(m);
+        raport << linii.str();
+        total.fisiere += partial.fisiere;
+        total.blocuri_total += partial.blocuri_total;
+        total.esantionate += partial.esantionate;
+        total.corupte += partial.corupte;
+        total.fisiere_lipsa += partial.fisiere_lipsa;
+        total.fisiere_modificate += partial.fisiere_modificate;
+    };
+    vector<thread> fire;
+    for (unsigned f = 1; f < optiuni.fire; f++)
+        fire.emplace_back(lucreaza);
+    lucreaza();
+    for (thread& fir : fire)
+        fir.join();
+    total.secunde = chrono::duration<double>(chrono::steady_clock::now() - inceput).count();
+    return total;
+}
+
+/* Intervalul de incredere 95% pentru fractia de blocuri corupte: Wilson pentru x > 0; pentru x = 0 limita superioara
+exacta unilaterala 1 - 0.05^(1/n) (aproximativ 3/n, "regula lui 3"). Esantionul este tratat ca extragere cu repunere,
+ceea ce da limite putin mai largi decat cele exacte cand fractia esantionata este mare. */
+void afisareIncredere(const RezultatEsantionare& r, ostream& iesire) {
+    iesire << r.fisiere << " fisiere, " << r.blocuri_total << " blocuri in index, " << r.esantionate << " esantionate, "
+        << r.corupte << " corupte, " << r.fisiere_lipsa << " fisiere lipsa, " << r.fisiere_modificate << " cu lungime modificata ("
+        << r.secunde << " s)." << endl;
+    if (!r.esantionate)
+        return;
+    double n = (double)r.esantionate, p = r.corupte / n, z = 1.96, inferior, superior;
+    if (r.corupte == 0) {
+        inferior = 0;
+        superior = 1 - pow(0.05, 1 / n);
+    }
+    else {
+        double numitor = 1 + z * z / n;
+        double centru = (p + z * z / (2 * n)) / numitor;
+        double raza = z * sqrt(p * (1 - p) / n + z * z / (4 * n * n)) / numitor;
+        inferior = max(0.0, centru - raza);
+        superior = min(1.0, centru + raza);
+    }
+    iesire << "Fractia de blocuri corupte: estimata " << 100 * p << "%, interval de incredere 95% [" << 100 * inferior << "%, "
+        << 100 * superior << "%]" << endl;
+    iesire << "Blocuri corupte in tot setul (estimare): " << (uint64_t)(p * r.blocuri_total) << ", cel mult "
+        << (uint64_t)ceil(superior * r.blocuri_total) << " cu incredere 95%." << endl;
+}
+
+/* Calitatea codurilor CRC folosite ca functii de dispersie (pentru impartirea pe fragmente si tabele de dispersie).
+Pentru fiecare model de cel putin 16 biti se masoara:
+  - avalansa: cat de des se schimba fiecare bit de iesire cand se inverseaza un bit al cheii. CRC-ul este afin, deci
+    schimbarea nu depinde de cheie: fiecare pereche (bit de intrare, bit de iesire) se schimba mereu sau niciodata. Numarul
+    mediu de biti schimbati poate fi totusi aproape de w/2, ceea ce ajunge pentru multe tabele, dar nu pentru chei alese de un adversar;
+  - uniformitatea pe galeti (test chi-patrat, dat ca scor z) dupa reducerea modulo un numar prim, cu bitii de jos si cu bitii de sus;
+  - coliziunile complete, fata de numarul asteptat pentru o functie aleatoare cu 2^w valori,
+pe chei aleatoare, intregi consecutivi, intregi cu pas 4096 si siruri cu un prefix comun lung.
+Un scor z sub -3 inseamna o distributie "prea uniforma" (tipic pentru o functie liniara pe chei consecutive), nu un defect. */
+
+#define GALETI_PRIM 1021
+#define BITI_GALETI 10
+#define LUNGIME_CHEIE_AVALANSA 16
+
+enum TipCheie { cheie_aleatoare, cheie_consecutiva, cheie_pas, cheie_prefix, numar_tipuri_cheie };
+const char* nume_tipuri_cheie[numar_tipuri_cheie] = { "aleatoare (16 octeti)", "intregi consecutivi", "intregi cu pas 4096", "prefix comun" };
+
+enum ReducereGaleti { reducere_modulo, reducere_biti_jos, reducere_biti_sus, numar_reduceri };
+const char* nume_reduceri[numar_reduceri] = { "mod 1021", "biti jos", "biti sus" };
+
+struct RezultatDispersie {
+    double z[numar_reduceri] = {};
+    uint64_t coliziuni = 0;
+    double coliziuni_asteptate = 0;
+};
+
+struct RezultatAvalansa {
+    double biti_schimbati = 0;      /* Media pe chei si pe bitii de intrare inversati. */
+    double abatere_maxima = 0;      /* max |P(bitul j se schimba) - 1/2| pe toate perechile. */
+    double perechi_deterministe = 0; /* Fractia perechilor cu probabilitatea 0 sau 1. */
+};
+
+struct RezultatCalitate {
+    string model;
+    int latime = 0;
+    RezultatAvalansa avalansa;
+    RezultatDispersie chei[numar_tipuri_cheie];
+};
+
+size_t genereazaCheie(TipCheie tip, uint64_t i, mt19937_64& generator, unsigned char* cheie) {
+    switch (tip) {
+    case cheie_aleatoare:
+        for (int k = 0; k < 16; k += 8) {
+            uint64_t x = generator();
+            memcpy(cheie + k, &x, 8);
+        }
+        return 16;
+    case cheie_consecutiva:
+    case cheie_pas: {
+        uint64_t x = tip == cheie_pas ? i * 4096 : i;
+        scrieLE32(cheie, (uint32_t)x);
+        scrieLE32(cheie + 4, (uint32_t)(x >> 32));
+        return 8;
+    }
+    default: {
+        int n = snprintf((char*)cheie, 64, "tenant-0042/obiecte/2024/utilizator:%llu", (unsigned long long)i);
+        return (size_t)n;
+    }
+    }
+}
+
+/* Scorul z al statisticii chi-patrat pentru "galeti" galeti: (chi2 - (g - 1)) / sqrt(2 (g - 1)). */
+double scorChiPatrat(const vector<uint64_t>& numarari, uint64_t chei) {
+    double asteptat = (double)chei / numarari.size(), chi2 = 0;
+    for (uint64_t c : numarari)
+        chi2 += (c - asteptat) * (c - asteptat) / asteptat;
+    double grade = (double)numarari.size() - 1;
+    return (chi2 - grade) / sqrt(2 * grade);
+}
+
+RezultatDispersie evalueazaDispersie(const MotorCRC& motor, TipCheie tip, uint64_t chei, uint64_t samanta) {
+    RezultatDispersie rezultat;
+    int latime = motor.descriere().latime;
+    mt19937_64 generator(samanta);
+    unsigned char cheie[64];
+    vector<uint64_t> valori(chei);
+    vector<uint64_t> numarari[numar_reduceri] = { vector<uint64_t>(GALETI_PRIM), vector<uint64_t>(1 << BITI_GALETI), vector<uint64_t>(1 << BITI_GALETI) };
+    for (uint64_t i = 0; i < chei; i++) {
+        uint64_t h = motor.calcul(cheie, genereazaCheie(tip, i, generator, cheie));
+        valori[i] = h;
+        numarari[reducere_modulo][h % GALETI_PRIM]++;
+        numarari[reducere_biti_jos][h & ((1 << BITI_GALETI) - 1)]++;
+        numarari[reducere_biti_sus][h >> (latime - BITI_GALETI)]++;
+    }
+    for (int r = 0; r < numar_reduceri; r++)
+        rezultat.z[r] = scorChiPatrat(numarari[r], chei);
+    sort(valori.begin(), valori.end());
+    for (uint64_t i = 1; i < chei; i++)
+        rezultat.coliziuni += valori[i] == valori[i - 1];
+    /* n - m (1 - (1 - 1/m)^n), cu m = 2^w. */
+    double m = ldexp(1.0, latime), n = (double)chei;
+    rezultat.coliziuni_asteptate = n + m * expm1(n * log1p(-1 / m));
+    return rezultat;
+}
+
+RezultatAvalansa evalueazaAvalansa(const MotorCRC& motor, uint64_t chei, uint64_t samanta) {
+    const int biti_intrare = 8 * LUNGIME_CHEIE_AVALANSA;
+    int latime = motor.descriere().latime;
+    vector<uint64_t> schimbari((size_t)biti_intrare * latime);
+    mt19937_64 generator(samanta);
+    unsigned char cheie[LUNGIME_CHEIE_AVALANSA];
+    uint64_t total_biti = 0;
+    for (uint64_t c = 0; c < chei; c++) {
+        for (unsigned char& octet : cheie)
+            octet = (unsigned char)generator();
+        uint64_t h = motor.calcul(cheie, sizeof cheie);
+        for (int b = 0; b < biti_intrare; b++) {
+            cheie[b / 8] ^= (unsigned char)(1 << (b % 8));
+            uint64_t diferenta = h ^ motor.calcul(cheie, sizeof cheie);
+            cheie[b / 8] ^= (unsigned char)(1 << (b % 8));
+            for (int j = 0; j < latime; j++) {
+                schimbari[(size_t)b * latime + j] += (diferenta >> j) & 1;
+                total_biti += (diferenta >> j) & 1;
+            }
+        }
+    }
+    RezultatAvalansa rezultat;
+    rezultat.biti_schimbati = (double)total_biti / ((double)chei * biti_intrare);
+    uint64_t deterministe = 0;
+    for (uint64_t s : schimbari) {
+        rezultat.abatere_maxima = max(rezultat.abatere_maxima, fabs((double)s / chei - 0.5));
+        deterministe += s == 0 || s == chei;
+    }
+    rezultat.perechi_deterministe = (double)deterministe / schimbari.size();
+    return rezultat;
+}
+
+/* Toate masuratorile, pentru toate modelele, impartite pe fire (o sarcina = un model si un tip de cheie, sau avalansa unui model). */
+vector<RezultatCalitate> testCalitateDispersie(uint64_t chei, uint64_t samanta) {
+    vector<const MotorCRC*> motoare;
+    for (int a = 0; a < numar_algoritmi; a++)
+        if (modele[a].latime >= 16)
+            motoare.push_back(&inregistreazaModel(modele[a]));
+    for (size_t i = 0; i < numar_modele_catalog; i++)
+        if (catalog_modele[i].latime >= 16)
+            motoare.push_back(&inregistreazaModel(catalog_modele[i]));
+    vector<RezultatCalitate> rezultate(motoare.size());
+    const size_t sarcini_pe_model = numar_tipuri_cheie + 1;
+    atomic<size_t> urmatoarea{ 0 };
+    auto lucreaza = [&] {
+        for (size_t s; (s = urmatoarea.fetch_add(1)) < motoare.size() * sarcini_pe_model;) {
+            const MotorCRC& motor = *motoare[s / sarcini_pe_model];
+            RezultatCalitate& rezultat = rezultate[s / sarcini_pe_model];
+            size_t tip = s % sarcini_pe_model;
+            if (tip == numar_tipuri_cheie)
+                rezultat.avalansa = evalueazaAvalansa(motor, min<uint64_t>(chei, 2000), samanta);
+            else
+                rezultat.chei[tip] = evalueazaDispersie(motor, (TipCheie)tip, chei, samanta + tip);
+        }
+    };
+    vector<thread> fire;
+    for (unsigned f = 1; f < max(1u, thread::hardware_concurrency()); f++)
+        fire.emplace_back(lucreaza);
+    lucreaza();
+    for (thread& fir : fire)
+        fir.join();
+    for (size_t i = 0; i < motoare.size(); i++) {
+        rezultate[i].model = motoare[i]->descriere().nume;
+        rezultate[i].latime = motoare[i]->descriere().latime;
+    }
+    return rezultate;
+}
+
+/* Scorurile z > 3 si coliziunile cu mult peste asteptari sunt marcate cu "!", distributiile prea uniforme (z < -3) cu "~".
+Un model fara "!" este o dispersie ieftina acceptabila pentru tipurile de chei testate (dar nu pentru chei alese de un adversar,
+vezi avalansa). */
+void afisareCalitateDispersie(const vector<RezultatCalitate>& rezultate, ostream& iesire) {
+    for (const RezultatCalitate& r : rezultate) {
+        iesire << r.model << " (" << r.latime << " biti): avalansa " << fixed << setprecision(2) << r.avalansa.biti_schimbati
+            << " biti schimbati in medie (ideal " << r.latime / 2.0 << "), abatere maxima " << r.avalansa.abatere_maxima << ", "
+            << 100 * r.avalansa.perechi_deterministe << "% perechi de biti deterministe" << endl;
+        int marcaje = 0;
+        for (int t = 0; t < numar_tipuri_cheie; t++) {
+            const RezultatDispersie& d = r.chei[t];
+            iesire << "    " << left << setw(24) << nume_tipuri_cheie[t] << right;
+            for (int red = 0; red < numar_reduceri; red++) {
+                bool rau = d.z[red] > 3;
+                marcaje += rau;
+                iesire << "  " << nume_reduceri[red] << " z=" << setw(9) << d.z[red] << (rau ? "!" : d.z[red] < -3 ? "~" : " ");
+            }
+            bool prea_multe = d.coliziuni > 2 * d.coliziuni_asteptate + 3 * sqrt(d.coliziuni_asteptate) + 1;
+            marcaje += prea_multe;
+            iesire << "  coliziuni " << d.coliziuni << " (asteptat " << d.coliziuni_asteptate << ")" << (prea_multe ? "!" : "") << endl;
+        }
+        iesire << "    " << (marcaje == 0 ? string("fara abateri semnificative") : marcaje == 1 ? string("o abatere semnificativa")
+            : to_string(marcaje) + " abateri semnificative") << endl;
+        iesire.unsetf(ios::floatfield);
+        iesire << setprecision(6);
+    }
+}
+
+/* Tabela de dispersie cu adresare deschisa pentru chei sir, in stilul "Swiss table".
+Functia de dispersie este CRC-32C: pe x86 cu SSE4.2 instructiunea crc32 consuma 8 octeti pe instructiune (alegerea se face o
+singura data, la executie); altfel se foloseste un tabel de cautare. Din codul de 32 de biti, cei 7 biti de jos sunt eticheta
+pastrata in octetul de control al slotului, iar restul alege grupul de pornire.
+Octetii de control sunt impartiti in grupuri de 16: o cautare compara eticheta cu tot grupul printr-o singura comparatie SSE2
+si compara cheile doar pentru sloturile cu eticheta potrivita; sondarea continua din grup in grup (pasi 1, 2, 3, ..., care
+ating toate grupurile cand numarul lor este o putere a lui 2) pana la un grup cu un slot gol.
+Cheile sunt copiate intr-o arena, asa ca sloturile contin doar pointerul, lungimea si codul complet, iar la redimensionare
+cheile nu se muta si nu se recalculeaza codurile. Memoria cheilor sterse se recupereaza doar prin golirea tabelei. */
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define DISPERSIE_SSE2
+#endif
+
+uint32_t crc32cTabel(uint32_t crc, const unsigned char* date, size_t lungime) {
+    static const vector<uint32_t> tabel = [] {
+        vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t r = i;
+            for (int bit = 0; bit < 8; bit++)
+                r = (r & 1) ? (r >> 1) ^ 0x82F63B78 : r >> 1;
+            t[i] = r;
+        }
+        return t;
+    }();
+    for (size_t i = 0; i < lungime; i++)
+        crc = (crc >> 8) ^ tabel[(crc ^ date[i]) & 0xFF];
+    return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t crc32cHardware(uint32_t crc, const unsigned char* date, size_t lungime) {
+    uint64_t stare = crc;
+    for (; lungime >= 8; date += 8, lungime -= 8) {
+        uint64_t cuvant;
+        memcpy(&cuvant, date, 8);
+        stare = _mm_crc32_u64(stare, cuvant);
+    }
+    crc = (uint32_t)stare;
+    for (size_t i = 0; i < lungime; i++)
+        crc = _mm_crc32_u8(crc, date[i]);
+    return crc;
+}
+#endif
+
+/* CRC-32C (valoare initiala si XOR final 0xFFFFFFFF) al cheii. */
+inline uint32_t dispersieCRC32C(const char* cheie, size_t lungime) {
+    static uint32_t (*const functie)(uint32_t, const unsigned char*, size_t) =
+#if defined(__x86_64__)
+        __builtin_cpu_supports("sse4.2") ? crc32cHardware :
+#endif
+        crc32cTabel;
+    return ~functie(0xFFFFFFFF, (const unsigned char*)cheie, lungime);
+}
+
+struct DispersieCRC32C {
+    size_t operator()(const string& cheie) const { return dispersieCRC32C(cheie.data(), cheie.size()); }
+};
+
+/* Copii ale cheilor, in blocuri care nu se muta niciodata. */
+class ArenaChei {
+public:
+    const char* copiaza(const char* date, size_t lungime) {
+        /* Cheia vida nu ocupa loc; inainte de primul bloc "curent" este nul, iar memcpy pe un pointer nul nu este definit. */
+        if (lungime == 0)
+            return "";
+        char* destinatie;
+        if (lungime > DIMENSIUNE_BLOC / 4) {
+            /* Cheile mari primesc un bloc propriu, ca sa nu se piarda restul blocului curent. */
+            blocuri.push_back(make_unique<char[]>(lungime));
+            destinatie = blocuri.back().get();
+        }
+        else {
+            if (lungime > ramas) {
+                blocuri.push_back(make_unique<char[]>(DIMENSIUNE_BLOC));
+                curent = blocuri.back().get();
+                ramas = DIMENSIUNE_BLOC;
+            }
+            destinatie = curent;
+            curent += lungime;
+            ramas -= lungime;
+        }
+        memcpy(destinatie, date, lungime);
+        ocupati += lungime;
+        return destinatie;
+    }
+    size_t octeti() const { return ocupati; }
+    void goleste() {
+        blocuri.clear();
+        curent = nullptr;
+        ramas = ocupati = 0;
+    }
+
+private:
+    static constexpr size_t DIMENSIUNE_BLOC = 64 * 1024;
+    vector<unique_ptr<char[]>> blocuri;
+    char* curent = nullptr;
+    size_t ramas = 0;
+    size_t ocupati = 0;
+};
+
+#define DIMENSIUNE_GRUP 16
+
+/* Mastile pe 16 biti ale sloturilor dintr-un grup: cu eticheta data, goale, respectiv libere (goale sau sterse). */
+struct GrupControl {
+    static constexpr int8_t GOL = -128;
+    static constexpr int8_t STERS = -2;
+
+    const int8_t* control;
+
+#if defined(DISPERSIE_SSE2)
+    uint32_t potriviri(int8_t eticheta) const {
+        __m128i grup = _mm_loadu_si128((const __m128i*)control);
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(grup, _mm_set1_epi8(eticheta)));
+    }
+    uint32_t goale() const {
+        __m128i grup = _mm_loadu_si128((const __m128i*)control);
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(grup, _mm_set1_epi8(GOL)));
+    }
+    uint32_t libere() const {
+        /* Doar GOL si STERS au bitul de semn; sloturile ocupate au eticheta intre 0 si 127. */
+        return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)control));
+    }
+#else
+    uint32_t potriviri(int8_t eticheta) const { return masca([eticheta](int8_t c) { return c == eticheta; }); }
+    uint32_t goale() const { return masca([](int8_t c) { return c == GOL; }); }
+    uint32_t libere() const { return masca([](int8_t c) { return c < 0; }); }
+    template<typename Conditie>
+    uint32_t masca(Conditie conditie) const {
+        uint32_t m = 0;
+        for (int i = 0; i < DIMENSIUNE_GRUP; i++)
+            m |= (uint32_t)conditie(control[i]) << i;
+        return m;
+    }
+#endif
+};
+
+inline int primulBit(uint32_t masca) {
+#if defined(__GNUC__)
+    return __builtin_ctz(masca);
+#else
+    int i = 0;
+    while (!((masca >> i) & 1))
+        i++;
+    return i;
+#endif
+}
+
+/* Valoare trebuie sa poata fi construita implicit. */
+template<typename Valoare>
+class TabelDispersie {
+public:
+    explicit TabelDispersie(size_t capacitate = 0) { redimensioneaza(capacitate); }
+
+    size_t marime() const { return ocupate; }
+    size_t capacitate() const { return control.size(); }
+    size_t octetiChei() const { return arena.octeti(); }
+
+    Valoare* gaseste(string_view cheie) {
+        size_t slot = cauta(cheie, dispersieCRC32C(cheie.data(), cheie.size()));
+        return slot == NEGASIT ? nullptr : &sloturi[slot].valoare;
+    }
+
+    /* Intoarce valoarea si true daca cheia a fost adaugata acum (valoarea existenta nu este inlocuita). */
+    pair<Valoare*, bool> insereaza(string_view cheie, Valoare valoare) {
+        uint32_t h = dispersieCRC32C(cheie.data(), cheie.size());
+        size_t slot = cauta(cheie, h);
+        if (slot != NEGASIT)
+            return { &sloturi[slot].valoare, false };
+        if (ocupate + sterse + 1 > control.size() / 8 * 7)
+            /* Daca jumatate din sloturile folosite sunt sterse, ajunge reconstruirea la aceeasi capacitate. */
+            redimensioneaza(sterse >= ocupate ? control.size() : control.size() * 2);
+        slot = slotLiber(h);
+        sterse -= control[slot] == GrupControl::STERS;
+        control[slot] = (int8_t)(h & 0x7F);
+        sloturi[slot] = { arena.copiaza(cheie.data(), cheie.size()), (uint32_t)cheie.size(), h, move(valoare) };
+        ocupate++;
+        return { &sloturi[slot].valoare, true };
+    }
+
+    Valoare& operator[](string_view cheie) { return *insereaza(cheie, Valoare()).first; }
+
+    bool sterge(string_view cheie) {
+        size_t slot = cauta(cheie, dispersieCRC32C(cheie.data(), cheie.size()));
+        if (slot == NEGASIT)
+            return false;
+        /* Un grup care are deja un slot gol opreste orice sondare, deci slotul poate redeveni gol in loc de "sters". */
+        if (GrupControl{ &control[slot / DIMENSIUNE_GRUP * DIMENSIUNE_GRUP] }.goale())
+            control[slot] = GrupControl::GOL;
+        else {
+            control[slot] = GrupControl::STERS;
+            sterse++;
+        }
+        sloturi[slot].valoare = Valoare();
+        ocupate--;
+        return true;
+    }
+
+    void goleste() {
+        fill(control.begin(), control.end(), GrupControl::GOL);
+        fill(sloturi.begin(), sloturi.end(), Slot());
+        arena.goleste();
+        ocupate = sterse = 0;
+    }
+
+    template<typename Functie>
+    void pentruFiecare(Functie functie) const {
+        for (size_t i = 0; i < control.size(); i++)
+            if (control[i] >= 0)
+                functie(string_view(sloturi[i].cheie, sloturi[i].lungime), sloturi[i].valoare);
+    }
+
+private:
+    struct Slot {
+        const char* cheie = nullptr;
+        uint32_t lungime = 0;
+        uint32_t dispersie = 0;
+        Valoare valoare = Valoare();
+    };
+    static constexpr size_t NEGASIT = SIZE_MAX;
+
+    size_t grupInitial(uint32_t h) const { return (h >> 7) & (control.size() / DIMENSIUNE_GRUP - 1); }
+
+    size_t cauta(string_view cheie, uint32_t h) const {
+        size_t masca_grupuri = control.size() / DIMENSIUNE_GRUP - 1;
+        for (size_t g = grupInitial(h), pas = 1;; g = (g + pas++) & masca_grupuri) {
+            GrupControl grup{ &control[g * DIMENSIUNE_GRUP] };
+            for (uint32_t m = grup.potriviri((int8_t)(h & 0x7F)); m; m &= m - 1) {
+                size_t slot = g * DIMENSIUNE_GRUP + primulBit(m);
+                const Slot& s = sloturi[slot];
+                if (s.dispersie == h && s.lungime == cheie.size() && (cheie.empty() || memcmp(s.cheie, cheie.data(), cheie.size()) == 0))
+                    return slot;
+            }
+            if (grup.goale())
+                return NEGASIT;
+        }
+    }
+
+    size_t slotLiber(uint32_t h) const {
+        size_t masca_grupuri = control.size() / DIMENSIUNE_GRUP - 1;
+        for (size_t g = grupInitial(h), pas = 1;; g = (g + pas++) & masca_grupuri)
+            if (uint32_t m = GrupControl{ &control[g * DIMENSIUNE_GRUP] }.libere())
+                return g * DIMENSIUNE_GRUP + primulBit(m);
+    }
+
+    /* Capacitatea devine cea mai mica putere a lui 2 (de cel putin un grup) care pastreaza incarcarea sub 7/8. */
+    void redimensioneaza(size_t capacitate_minima) {
+        size_t capacitate_noua = DIMENSIUNE_GRUP;
+        while (capacitate_noua < capacitate_minima || capacitate_noua / 8 * 7 <= ocupate)
+            capacitate_noua *= 2;
+        vector<int8_t> control_vechi = move(control);
+        vector<Slot> sloturi_vechi = move(sloturi);
+        control.assign(capacitate_noua, GrupControl::GOL);
+        sloturi.assign(capacitate_noua, Slot());
+        sterse = 0;
+        for (size_t i = 0; i < control_vechi.size(); i++)
+            if (control_vechi[i] >= 0) {
+                size_t slot = slotLiber(sloturi_vechi[i].dispersie);
+                control[slot] = control_vechi[i];
+                sloturi[slot] = move(sloturi_vechi[i]);
+            }
+    }
+
+    vector<int8_t> control;
+    vector<Slot> sloturi;
+    ArenaChei arena;
+    size_t ocupate = 0;
+    size_t sterse = 0;
+};
+
+/* Compara TabelDispersie cu std::unordered_map pe inserari, cautari si stergeri aleatoare, incepand cu cheia vida
+(inserata intr-un tabel gol, inainte ca arena sa aiba vreun bloc) si cautand-o si printr-un string_view fara date. */
+int verificareTabelDispersie(uint64_t samanta, ostream& raport) {
+    mt19937_64 generator(samanta);
+    TabelDispersie<uint64_t> tabel;
+    unordered_map<string, uint64_t> referinta;
+    int nepotriviri = 0;
+    auto verifica = [&](const string& cheie, const char* operatie) {
+        uint64_t* gasit = tabel.gaseste(cheie);
+        auto it = referinta.find(cheie);
+        if ((gasit == nullptr) != (it == referinta.end()) || (gasit && *gasit != it->second) || tabel.marime() != referinta.size()) {
+            nepotriviri++;
+            raport << "TabelDispersie / " << operatie << ": cheia \"" << cheie << "\" (" << cheie.size() << " octeti)" << endl;
+        }
+    };
+    tabel.insereaza(string_view(), 7);
+    referinta.emplace("", 7);
+    verifica("", "inserarea cheii vide");
+    if (!tabel.gaseste(string_view()) || tabel.insereaza("", 8).second) {
+        nepotriviri++;
+        raport << "TabelDispersie / cheia vida: negasita prin string_view() sau inserata de doua ori" << endl;
+    }
+    for (int i = 0; i < 2000 && nepotriviri < 10; i++) {
+        string cheie(generator() % 8 == 0 ? 0 : generator() % 40, 'a');
+        for (char& c : cheie)
+            c = (char)('a' + generator() % 4);
+        if (generator() % 3 == 0) {
+            tabel.sterge(cheie);
+            referinta.erase(cheie);
+            verifica(cheie, "stergere");
+        }
+        else {
+            tabel.insereaza(cheie, (uint64_t)i);
+            referinta.emplace(cheie, (uint64_t)i);
+            verifica(cheie, "inserare");
+        }
+    }
+    for (const auto& pereche : referinta)
+        verifica(pereche.first, "cautare finala");
+    return nepotriviri;
+}
+
+/* Benchmark: TabelDispersie fata de std::unordered_map (cu std::hash si cu CRC-32C), pe aceleasi chei si in aceeasi ordine.
+Fazele sunt inserare, cautari reusite (in alta ordine decat inserarea), cautari esuate si stergerea unei jumatati din chei;
+sumele valorilor gasite trebuie sa fie aceleasi pentru toate implementarile. */
+
+struct RezultatBenchmarkDispersie {
+    double ns_inserare = 0, ns_gasite = 0, ns_negasite = 0, ns_stergere = 0;
+    uint64_t suma = 0;
+};
+
+template<typename Tabel, typename Insereaza, typename Gaseste, typename Sterge>
+RezultatBenchmarkDispersie masoaraTabel(Tabel& tabel, const vector<string>& chei, const vector<string>& absente, const vector<uint32_t>& ordine,
+    Insereaza insereaza, Gaseste gaseste, Sterge sterge) {
+    RezultatBenchmarkDispersie r;
+    auto ns = [](chrono::steady_clock::time_point inceput, size_t operatii) {
+        return chrono::duration<double, nano>(chrono::steady_clock::now() - inceput).count() / max<size_t>(operatii, 1);
+    };
+    auto inceput = chrono::steady_clock::now();
+    for (size_t i = 0; i < chei.size(); i++)
+        insereaza(tabel, chei[i], (uint64_t)i);
+    r.ns_inserare = ns(inceput, chei.size());
+    inceput = chrono::steady_clock::now();
+    for (uint32_t i : ordine)
+        r.suma += gaseste(tabel, chei[i]);
+    r.ns_gasite = ns(inceput, ordine.size());
+    inceput = chrono::steady_clock::now();
+    for (const string& cheie : absente)
+        r.suma += gaseste(tabel, cheie);
+    r.ns_negasite = ns(inceput, absente.size());
+    inceput = chrono::steady_clock::now();
+    for (size_t i = 0; i < ordine.size(); i += 2)
+        sterge(tabel, chei[ordine[i]]);
+    r.ns_stergere = ns(inceput, (ordine.size() + 1) / 2);
+    for (uint32_t i : ordine)
+        r.suma += gaseste(tabel, chei[i]);
+    return r;
+}
+
+void benchmarkDispersie(size_t numar_chei, size_t lungime_cheie, uint64_t samanta, ostream& iesire) {
+    mt19937_64 generator(samanta);
+    /* Chei cu un prefix comun si un sufix aleator, ca in identificatorii obisnuiti; cele absente difera doar prin ultimul caracter. */
+    auto cheie = [&](char ultimul) {
+        string s = "obiect/";
+        while (s.size() + 1 < lungime_cheie)
+            s += (char)('a' + generator() % 26);
+        return s + ultimul;
+    };
+    vector<string> chei, absente;
+    for (size_t i = 0; i < numar_chei; i++) {
+        chei.push_back(cheie('0' + (char)(i % 10)));
+        absente.push_back(chei.back());
+        absente.back().back() = '#';
+    }
+    /* Cheile repetate ar face sumele sa depinda de implementare; cu sufixe aleatoare ele sunt rare, dar se elimina. */
+    sort(chei.begin(), chei.end());
+    chei.erase(unique(chei.begin(), chei.end()), chei.end());
+    shuffle(chei.begin(), chei.end(), generator);
+    vector<uint32_t> ordine(chei.size());
+    for (size_t i = 0; i < ordine.size(); i++)
+        ordine[i] = (uint32_t)i;
+    shuffle(ordine.begin(), ordine.end(), generator);
+
+    uint64_t octeti = 0;
+    for (const string& s : chei)
+        octeti += s.size();
+    auto inceput = chrono::steady_clock::now();
+    uint64_t control = 0;
+    for (const string& s : chei)
+        control += dispersieCRC32C(s.data(), s.size());
+    double ns_crc = chrono::duration<double, nano>(chrono::steady_clock::now() - inceput).count();
+    inceput = chrono::steady_clock::now();
+    for (const string& s : chei)
+        control += hash<string>()(s);
+    double ns_std = chrono::duration<double, nano>(chrono::steady_clock::now() - inceput).count();
+    rezultat_reluare = control;
+    iesire << chei.size() << " chei de " << lungime_cheie << " octeti. Dispersie: CRC-32C " << ns_crc / max<size_t>(chei.size(), 1)
+        << " ns/cheie (" << octeti / max(ns_crc, 1.0) << " GB/s), std::hash " << ns_std / max<size_t>(chei.size(), 1) << " ns/cheie ("
+        << octeti / max(ns_std, 1.0) << " GB/s)" << endl;
+
+    auto afiseaza = [&](const char* nume, const RezultatBenchmarkDispersie& r) {
+        iesire << "    " << left << setw(34) << nume << right << fixed << setprecision(1) << "inserare " << setw(7) << r.ns_inserare
+            << "  gasite " << setw(7) << r.ns_gasite << "  negasite " << setw(7) << r.ns_negasite << "  stergere " << setw(7)
+            << r.ns_stergere << " ns/op" << endl;
+        iesire.unsetf(ios::floatfield);
+        iesire << setprecision(6);
+    };
+    RezultatBenchmarkDispersie rezultate[3];
+    {
+        TabelDispersie<uint64_t> tabel;
+        rezultate[0] = masoaraTabel(tabel, chei, absente, ordine,
+            [](TabelDispersie<uint64_t>& t, const string& k, uint64_t v) { t.insereaza(k, v); },
+            [](TabelDispersie<uint64_t>& t, const string& k) { uint64_t* v = t.gaseste(k); return v ? *v + 1 : 0; },
+            [](TabelDispersie<uint64_t>& t, const string& k) { t.sterge(k); });
+    }
+    {
+        unordered_map<string, uint64_t> tabel;
+        rezultate[1] = masoaraTabel(tabel, chei, absente, ordine,
+            [](unordered_map<string, uint64_t>& t, const string& k, uint64_t v) { t.emplace(k, v); },
+            [](unordered_map<string, uint64_t>& t, const string& k) { auto it = t.find(k); return it == t.end() ? 0 : it->second + 1; },
+            [](unordered_map<string, uint64_t>& t, const string& k) { t.erase(k); });
+    }
+    {
+        unordered_map<string, uint64_t, DispersieCRC32C> tabel;
+        rezultate[2] = masoaraTabel(tabel, chei, absente, ordine,
+            [](unordered_map<string, uint64_t, DispersieCRC32C>& t, const string& k, uint64_t v) { t.emplace(k, v); },
+            [](unordered_map<string, uint64_t, DispersieCRC32C>& t, const string& k) { auto it = t.find(k); return it == t.end() ? 0 : it->second + 1; },
+            [](unordered_map<string, uint64_t, DispersieCRC32C>& t, const string& k) { t.erase(k); });
+    }
+    afiseaza("TabelDispersie (CRC-32C)", rezultate[0]);
+    afiseaza("unordered_map (std::hash)", rezultate[1]);
+    afiseaza("unordered_map (CRC-32C)", rezultate[2]);
+    if (rezultate[0].suma != rezultate[1].suma || rezultate[0].suma != rezultate[2].suma)
+        iesire << "Rezultate diferite intre implementari: " << rezultate[0].suma << ", " << rezultate[1].suma << ", " << rezultate[2].suma << endl;
+}
+
+/* Reconcilierea a doua replici pe baza indexurilor de blocuri (construite separat, eventual pe alte masini, cu optiunea 26
+sau cu "checksum --index"). Pentru fiecare fisier comun se construieste peste CRC-urile blocurilor un arbore binar de coduri
+combinate (nodul = combinaCRC32(stanga, dreapta, lungime(dreapta)), radacina = CRC-ul fisierului intreg) si arborii celor doua
+replici se compara de sus in jos: un subarbore cu acelasi cod este sarit intreg, deci pentru putine diferente numarul de
+comparatii este proportional cu (diferente x inaltime), nu cu numarul de blocuri. Ca orice comparatie prin CRC32, doua
+portiuni diferite cu acelasi cod (probabilitate 2^-32 pe nod) nu sunt detectate.
+Rezultatul este lista minima de actiuni care aduce replica la starea sursei: intervale de resincronizat (blocuri diferite
+vecine unite), fisiere de copiat, de sters sau de trunchiat. */
+
+enum TipActiune { actiune_resincronizare, actiune_copiere, actiune_trunchiere, actiune_stergere };
+const char* nume_actiuni[] = { "RESINCRONIZARE", "COPIERE", "TRUNCHIERE", "STERGERE" };
+
+struct ActiuneResincronizare {
+    TipActiune tip;
+    string cale;
+    uint64_t deplasare, lungime;
+};
+
+struct RezultatReconciliere {
+    vector<ActiuneResincronizare> actiuni;
+    uint64_t fisiere_identice = 0;
+    uint64_t octeti_de_transferat = 0;
+    uint64_t blocuri_comparabile = 0;
+    uint64_t comparatii = 0;
+};
+
+struct NodCombinat {
+    CRC32 crc;
+    uint64_t lungime;
+};
+
+/* Nivelurile arborelui peste primele "numar" blocuri; nivelul 0 sunt blocurile, ultimul nivel are un singur nod. */
+vector<vector<NodCombinat>> arboreCombinat(const FisierIndexat& f, size_t numar, uint32_t dimensiune_bloc) {
+    vector<vector<NodCombinat>> niveluri(1);
+    for (size_t i = 0; i < numar; i++)
+        niveluri[0].push_back({ f.blocuri[i], min<uint64_t>(dimensiune_bloc, f.lungime - (uint64_t)i * dimensiune_bloc) });
+    while (niveluri.back().size() > 1) {
+        const vector<NodCombinat>& jos = niveluri.back();
+        vector<NodCombinat> sus;
+        for (size_t i = 0; i < jos.size(); i += 2)
+            sus.push_back(i + 1 < jos.size() ? NodCombinat{ combinaCRC32(jos[i].crc, jos[i + 1].crc, jos[i + 1].lungime), jos[i].lungime + jos[i + 1].lungime } : jos[i]);
+        niveluri.push_back(move(sus));
+    }
+    return niveluri;
+}
+
+void coboaraDiferente(const vector<vector<NodCombinat>>& a, const vector<vector<NodCombinat>>& b, size_t nivel, size_t nod,
+    vector<size_t>& diferite, uint64_t& comparatii) {
+    comparatii++;
+    if (a[nivel][nod].crc == b[nivel][nod].crc)
+        return;
+    if (nivel == 0) {
+        diferite.push_back(nod);
+        return;
+    }
+    for (size_t copil = 2 * nod; copil < min(2 * nod + 2, a[nivel - 1].size()); copil++)
+        coboaraDiferente(a, b, nivel - 1, copil, diferite, comparatii);
+}
+
+void adaugaInterval(RezultatReconciliere& r, const string& cale, uint64_t deplasare, uint64_t lungime) {
+    if (!r.actiuni.empty() && r.actiuni.back().tip == actiune_resincronizare && r.actiuni.back().cale == cale
+        && r.actiuni.back().deplasare + r.actiuni.back().lungime == deplasare)
+        r.actiuni.back().lungime += lungime;
+    else
+        r.actiuni.push_back({ actiune_resincronizare, cale, deplasare, lungime });
+    r.octeti_de_transferat += lungime;
+}
+
+void reconciliazaFisier(const FisierIndexat& sursa, const FisierIndexat& replica, uint32_t dimensiune_bloc, RezultatReconciliere& r) {
+    if (sursa.lungime == replica.lungime && sursa.crc == replica.crc) {
+        r.comparatii++;
+        r.fisiere_identice++;
+        return;
+    }
+    /* Blocurile comparabile au aceeasi lungime in ambele replici: toate, daca fisierele au aceeasi lungime, altfel doar blocurile
+    complete din portiunea comuna. Restul sursei se transfera intreg, iar o replica mai lunga se trunchiaza. */
+    uint64_t comun = min(sursa.lungime, replica.lungime);
+    size_t comparabile = sursa.lungime == replica.lungime ? sursa.blocuri.size() : (size_t)(comun / dimensiune_bloc);
+    r.blocuri_comparabile += comparabile;
+    vector<size_t> diferite;
+    if (comparabile) {
+        vector<vector<NodCombinat>> a = arboreCombinat(sursa, comparabile, dimensiune_bloc), b = arboreCombinat(replica, comparabile, dimensiune_bloc);
+        coboaraDiferente(a, b, a.size() - 1, 0, diferite, r.comparatii);
+    }
+    for (size_t bloc : diferite)
+        adaugaInterval(r, sursa.cale, (uint64_t)bloc * dimensiune_bloc, min<uint64_t>(dimensiune_bloc, sursa.lungime - (uint64_t)bloc * dimensiune_bloc));
+    uint64_t sfarsit_comparat = (uint64_t)comparabile * dimensiune_bloc;
+    if (sursa.lungime > sfarsit_comparat && sursa.lungime != replica.lungime)
+        adaugaInterval(r, sursa.cale, sfarsit_comparat, sursa.lungime - sfarsit_comparat);
+    if (replica.lungime > sursa.lungime)
+        r.actiuni.push_back({ actiune_trunchiere, sursa.cale, sursa.lungime, 0 });
+}
+
+/* Intoarce false daca indexurile nu folosesc aceeasi dimensiune de bloc (blocurile nu s-ar putea compara). */
+bool reconciliazaIndexuri(const IndexCRC& sursa, const IndexCRC& replica, RezultatReconciliere& r, string& eroare) {
+    if (sursa.dimensiune_bloc != replica.dimensiune_bloc) {
+        eroare = "dimensiuni de bloc diferite (" + to_string(sursa.dimensiune_bloc) + " si " + to_string(replica.dimensiune_bloc) + " octeti)";
+        return false;
+    }
+    map<string, const FisierIndexat*> fisiere_sursa, fisiere_replica;
+    for (const FisierIndexat& f : sursa.fisiere)
+        fisiere_sursa[f.cale] = &f;
+    for (const FisierIndexat& f : replica.fisiere)
+        fisiere_replica[f.cale] = &f;
+    for (const auto& [cale, f] : fisiere_sursa) {
+        auto it = fisiere_replica.find(cale);
+        if (it == fisiere_replica.end()) {
+            r.actiuni.push_back({ actiune_copiere, cale, 0, f->lungime });
+            r.octeti_de_transferat += f->lungime;
+        }
+        else
+            reconciliazaFisier(*f, *it->second, sursa.dimensiune_bloc, r);
+    }
+    for (const auto& [cale, f] : fisiere_replica)
+        if (!fisiere_sursa.count(cale))
+            r.actiuni.push_back({ actiune_stergere, cale, 0, 0 });
+    return true;
+}
+
+/* O actiune pe linie: "RESINCRONIZARE  deplasare  lungime  cale", "COPIERE  0  lungime  cale", "TRUNCHIERE  lungime  0  cale",
+"STERGERE  0  0  cale"; numerele sunt zecimale, iar calea (care poate contine spatii) este ultima. */
+void scrieActiuni(const RezultatReconciliere& r, ostream& iesire) {
+    for (const ActiuneResincronizare& a : r.actiuni)
+        iesire << nume_actiuni[a.tip] << "  " << a.deplasare << "  " << a.lungime << "  " << a.cale << "\n";
+}
+
+void afisareReconciliere(const RezultatReconciliere& r, ostream& iesire) {
+    uint64_t numarari[4] = {};
+    for (const ActiuneResincronizare& a : r.actiuni)
+        numarari[a.tip]++;
+    iesire << r.fisiere_identice << " fisiere identice; " << numarari[actiune_resincronizare] << " intervale de resincronizat, "
+        << numarari[actiune_copiere] << " fisiere de copiat, " << numarari[actiune_trunchiere] << " de trunchiat, "
+        << numarari[actiune_stergere] << " de sters." << endl;
+    iesire << "Octeti de transferat: " << r.octeti_de_transferat << ". Comparatii de coduri: " << r.comparatii << " (pentru "
+        << r.blocuri_comparabile << " blocuri comparabile in fisierele diferite)." << endl;
+}
+
+/* Compararea a doua fisiere (checksum --compare A B): distanta Hamming la nivel de bit pe portiunea comuna, CRC32 pentru
+fiecare bloc al fiecarui fisier si intervalele de octeti care difera. Fisierele sunt mapate in memorie si parcurse o singura
+data, in paralel pe blocuri; in fiecare bloc, bucati de 64 KB sunt trecute prin ambele CRC-uri (plierea PCLMUL) si prin
+XOR + numararea bitilor (AVX2) cat timp sunt inca in cache. */
+
+#define BUCATA_COMPARATIE (64 * 1024)
+
+inline int numarBiti(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+uint64_t distantaHammingScalar(const unsigned char* a, const unsigned char* b, size_t lungime) {
+    uint64_t distanta = 0;
+    size_t i = 0;
+    for (; i + 8 <= lungime; i += 8) {
+        uint64_t x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        distanta += numarBiti(x ^ y);
+    }
+    for (; i < lungime; i++)
+        distanta += numarBiti(a[i] ^ b[i]);
+    return distanta;
+}
+
+#if defined(__x86_64__)
+/* Numararea bitilor cu tabel de 16 intrari in registru (vpshufb pe fiecare jumatate de octet); contoarele pe octet se aduna
+in cel mult 31 de pasi (31 * 8 < 256) si apoi se strang in 4 contoare de 64 de biti cu vpsadbw. */
+__attribute__((target("avx2"))) uint64_t distantaHammingAVX2(const unsigned char* a, const unsigned char* b, size_t lungime) {
+    const __m256i tabel = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i jumatate = _mm256_set1_epi8(0x0F);
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0;
+    while (i + 32 <= lungime) {
+        __m256i contoare = _mm256_setzero_si256();
+        for (int pas = 0; pas < 31 && i + 32 <= lungime; pas++, i += 32) {
+            __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i)));
+            __m256i jos = _mm256_shuffle_epi8(tabel, _mm256_and_si256(x, jumatate));
+            __m256i sus = _mm256_shuffle_epi8(tabel, _mm256_and_si256(_mm256_srli_epi16(x, 4), jumatate));
+            contoare = _mm256_add_epi8(contoare, _mm256_add_epi8(jos, sus));
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(contoare, _mm256_setzero_si256()));
+    }
+    uint64_t sume[4];
+    _mm256_storeu_si256((__m256i*)sume, total);
+    return sume[0] + sume[1] + sume[2] + sume[3] + distantaHammingScalar(a + i, b + i, lungime - i);
+}
+#endif
+
+uint64_t distantaHamming(const unsigned char* a, const unsigned char* b, size_t lungime) {
+    static uint64_t (*const functie)(const unsigned char*, const unsigned char*, size_t) =
+#if defined(__x86_64__)
+        __builtin_cpu_supports("avx2") ? distantaHammingAVX2 :
+#endif
+        distantaHammingScalar;
+    return functie(a, b, lungime);
+}
+
+/* Un fisier mapat doar pentru citire; pe platformele fara mapare este citit in memorie. Fisierele goale nu au mapare. */
+class FisierMapat {
+public:
+    explicit FisierMapat(const string& cale) {
+#if defined(_WIN32)
+        fisier = CreateFileA(cale.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        LARGE_INTEGER dimensiune;
+        if (fisier == INVALID_HANDLE_VALUE || !GetFileSizeEx(fisier, &dimensiune))
+            return;
+        n = (uint64_t)dimensiune.QuadPart;
+        if (n) {
+            mapare = CreateFileMappingA(fisier, NULL, PAGE_READONLY, 0, 0, NULL);
+            p = mapare ? (const unsigned char*)MapViewOfFile(mapare, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (!p)
+                return;
+        }
+        deschis_ok = true;
+#elif defined(__unix__) || defined(__APPLE__)
+        int fd = open(cale.c_str(), O_RDONLY);
+        struct stat informatii;
+        if (fd < 0)
+            return;
+        if (fstat(fd, &informatii) == 0 && S_ISREG(informatii.st_mode) && (uint64_t)informatii.st_size <= SIZE_MAX) {
+            n = (uint64_t)informatii.st_size;
+            void* adresa = n ? mmap(nullptr, (size_t)n, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+            if (adresa != MAP_FAILED) {
+                p = (const unsigned char*)adresa;
+                /* Valorile madvise nu sunt indicatori combinabili; citirea in avans se cere pe blocuri, prin preincarca. */
+                if (p)
+                    madvise(adresa, (size_t)n, MADV_SEQUENTIAL);
+                deschis_ok = true;
+            }
+        }
+        close(fd);
+#else
+        if (citireFisier(cale, continut)) {
+            p = (const unsigned char*)continut.data();
+            n = continut.size();
+            deschis_ok = true;
+        }
+#endif
+    }
+
+    ~FisierMapat() {
+#if defined(_WIN32)
+        if (p)
+            UnmapViewOfFile(p);
+        if (mapare)
+            CloseHandle(mapare);
+        if (fisier != INVALID_HANDLE_VALUE)
+            CloseHandle(fisier);
+#elif defined(__unix__) || defined(__APPLE__)
+        if (p)
+            munmap((void*)p, (size_t)n);
+#endif
+    }
+
+    FisierMapat(const FisierMapat&) = delete;
+    FisierMapat& operator=(const FisierMapat&) = delete;
+
+    bool deschis() const { return deschis_ok; }
+    const unsigned char* date() const { return p; }
+    uint64_t lungime() const { return n; }
+
+    /* Cere citirea in avans a intervalului [deplasare, deplasare + lungime), inainte ca un fir sa inceapa sa-l parcurga. */
+    void preincarca(uint64_t deplasare, uint64_t lungime_interval) const {
+#if defined(__unix__) || defined(__APPLE__)
+        if (!p || deplasare >= n)
+            return;
+        static const uint64_t pagina = (uint64_t)sysconf(_SC_PAGESIZE);
+        uint64_t inceput = deplasare / pagina * pagina, sfarsit = min(n, deplasare + lungime_interval);
+        madvise((void*)(p + inceput), (size_t)(sfarsit - inceput), MADV_WILLNEED);
+#else
+        (void)deplasare; (void)lungime_interval;
+#endif
+    }
+
+private:
+    const unsigned char* p = nullptr;
+    uint64_t n = 0;
+    bool deschis_ok = false;
+#if defined(_WIN32)
+    HANDLE fisier = INVALID_HANDLE_VALUE;
+    HANDLE mapare = NULL;
+#elif !defined(__unix__) && !defined(__APPLE__)
+    string continut;
+#endif
+};
+
+struct IntervalDiferit {
+    uint64_t inceput, sfarsit;      /* [inceput, sfarsit) */
+};
+
+struct RezultatComparatie {
+    uint64_t lungime_a = 0, lungime_b = 0;
+    uint32_t dimensiune_bloc = 0;
+    uint64_t distanta_hamming = 0;  /* Pe portiunea comuna; octetii in plus ai fisierului mai lung nu sunt numarati. */
+    uint64_t blocuri_diferite = 0;
+    vector<CRC32> blocuri_a, blocuri_b;
+    vector<uint64_t> biti_diferiti;
+    vector<IntervalDiferit> intervale;
+    double secunde = 0;
+};
+
+RezultatComparatie comparaFisiere(const FisierMapat& a, const FisierMapat& b, uint32_t dimensiune_bloc, unsigned numar_fire) {
+    RezultatComparatie r;
+    r.lungime_a = a.lungime();
+    r.lungime_b = b.lungime();
+    r.dimensiune_bloc = dimensiune_bloc;
+    uint64_t comun = min(r.lungime_a, r.lungime_b), maxim = max(r.lungime_a, r.lungime_b);
+    size_t numar_blocuri = (size_t)((maxim + dimensiune_bloc - 1) / dimensiune_bloc);
+    r.blocuri_a.assign(numar_blocuri, 0);
+    r.blocuri_b.assign(numar_blocuri, 0);
+    r.biti_diferiti.assign(numar_blocuri, 0);
+    const MotorCRC& motor = inregistreazaModel(modele[algoritm_crc32]);
+    atomic<size_t> urmatorul{ 0 };
+    atomic<uint64_t> distanta{ 0 };
+    auto inceput = chrono::steady_clock::now();
+    auto lucreaza = [&] {
+        uint64_t distanta_fir = 0;
+        for (size_t bloc; (bloc = urmatorul.fetch_add(1)) < numar_blocuri;) {
+            uint64_t deplasare = (uint64_t)bloc * dimensiune_bloc;
+            uint64_t sfarsit_a = min<uint64_t>(r.lungime_a, deplasare + dimensiune_bloc), sfarsit_b = min<uint64_t>(r.lungime_b, deplasare + dimensiune_bloc);
+            uint64_t stare_a = motor.stareInitiala(), stare_b = stare_a, biti = 0;
+            a.preincarca(deplasare, dimensiune_bloc);
+            b.preincarca(deplasare, dimensiune_bloc);
+            for (uint64_t p = deplasare; p < max(sfarsit_a, sfarsit_b); p += BUCATA_COMPARATIE) {
+                size_t bucata_a = p < sfarsit_a ? (size_t)min<uint64_t>(BUCATA_COMPARATIE, sfarsit_a - p) : 0;
+                size_t bucata_b = p < sfarsit_b ? (size_t)min<uint64_t>(BUCATA_COMPARATIE, sfarsit_b - p) : 0;
+                if (bucata_a)
+                    stare_a = motor.actualizare(stare_a, a.date() + p, bucata_a);
+                if (bucata_b)
+                    stare_b = motor.actualizare(stare_b, b.date() + p, bucata_b);
+                if (p < comun)
+                    biti += distantaHamming(a.date() + p, b.date() + p, (size_t)min<uint64_t>(BUCATA_COMPARATIE, min(sfarsit_a, sfarsit_b) - p));
+            }
+            r.blocuri_a[bloc] = (CRC32)motor.finalizare(stare_a);
+            r.blocuri_b[bloc] = (CRC32)motor.finalizare(stare_b);
+            r.biti_diferiti[bloc] = biti;
+            distanta_fir += biti;
+        }
+        distanta.fetch_add(distanta_fir);
+    };
+    vector<thread> fire;
+    for (unsigned f = 1; f < max(1u, numar_fire); f++)
+        fire.emplace_back(lucreaza);
+    lucreaza();
+    for (thread& fir : fire)
+        fir.join();
+    r.distanta_hamming = distanta.load();
+    /* Blocurile diferite vecine se unesc intr-un singur interval; un bloc care depaseste portiunea comuna difera mereu. */
+    for (size_t bloc = 0; bloc < numar_blocuri; bloc++) {
+        uint64_t deplasare = (uint64_t)bloc * dimensiune_bloc;
+        uint64_t sfarsit = min<uint64_t>(maxim, deplasare + dimensiune_bloc);
+        if (!r.biti_diferiti[bloc] && sfarsit <= comun)
+            continue;
+        r.blocuri_diferite++;
+        if (!r.intervale.empty() && r.intervale.back().sfarsit == deplasare)
+            r.intervale.back().sfarsit = sfarsit;
+        else
+            r.intervale.push_back({ deplasare, sfarsit });
+    }
+    r.secunde = chrono::duration<double>(chrono::steady_clock::now() - inceput).count();
+    return r;
+}
+
+void afisareComparatie(const RezultatComparatie& r, ostream& iesire) {
+    uint64_t comun = min(r.lungime_a, r.lungime_b);
+    iesire << "A: " << r.lungime_a << " octeti, B: " << r.lungime_b << " octeti";
+    if (r.lungime_a != r.lungime_b)
+        iesire << " (lungimi diferite, " << max(r.lungime_a, r.lungime_b) - comun << " octeti in plus)";
+    iesire << endl;
+    iesire << "Distanta Hamming: " << r.distanta_hamming << " biti din " << 8 * comun << " comuni";
+    if (comun)
+        iesire << " (" << 100.0 * r.distanta_hamming / (8.0 * comun) << "%)";
+    iesire << endl;
+    iesire << "Blocuri diferite: " << r.blocuri_diferite << " din " << r.biti_diferiti.size()
+        << " (blocuri de " << r.dimensiune_bloc << " octeti)" << endl;
+    const size_t MAXIM_AFISATE = 50;
+    for (size_t i = 0; i < r.intervale.size() && i < MAXIM_AFISATE; i++)
+        iesire << "    [" << r.intervale[i].inceput << ", " << r.intervale[i].sfarsit << ")  " << r.intervale[i].sfarsit - r.intervale[i].inceput << " octeti" << endl;
+    if (r.intervale.size() > MAXIM_AFISATE)
+        iesire << "    ... si inca " << r.intervale.size() - MAXIM_AFISATE << " intervale" << endl;
+    iesire << "Timp: " << r.secunde << " s (" << (r.lungime_a + r.lungime_b) / max(r.secunde, 1e-9) / 1e9 << " GB/s)." << endl;
+}
+
+/* Cate o linie pe bloc: "bloc  deplasare  crc_a  crc_b  biti_diferiti"; un bloc care lipseste dintr-un fisier are "--------". */
+void scrieRaportComparatie(const RezultatComparatie& r, ostream& raport) {
+    char linie[96];
+    for (size_t bloc = 0; bloc < r.biti_diferiti.size(); bloc++) {
+        uint64_t deplasare = (uint64_t)bloc * r.dimensiune_bloc;
+        char crc_a[9] = "--------", crc_b[9] = "--------";
+        if (deplasare < r.lungime_a)
+            snprintf(crc_a, sizeof crc_a, "%08x", (unsigned)r.blocuri_a[bloc]);
+        if (deplasare < r.lungime_b)
+            snprintf(crc_b, sizeof crc_b, "%08x", (unsigned)r.blocuri_b[bloc]);
+        snprintf(linie, sizeof linie, "%zu  %012llx  %s  %s  %llu\n", bloc, (unsigned long long)deplasare, crc_a, crc_b,
+            (unsigned long long)r.biti_diferiti[bloc]);
+        raport << linie;
+    }
+}
+
+/* Modul linie de comanda:
+    checksum --compare A B [--bloc KB] [--fire N] [--raport fisier]
+    checksum --index cale index [--bloc KB]
+    checksum --reconcile index_sursa index_replica [--raport fisier]
+Codurile de iesire urmeaza cmp: 0 = identice, 1 = diferite, 2 = eroare (--index intoarce 0 sau 2). */
+int linieComanda(int argc, char* argv[]) {
+    vector<string> argumente(argv + 1, argv + argc);
+    const char* utilizare = "Utilizare: checksum --compare A B [--bloc KB] [--fire N] [--raport fisier]\n"
+        "           checksum --index cale index [--bloc KB]\n"
+        "           checksum --reconcile index_sursa index_replica [--raport fisier]";
+    if (argumente.size() < 3 || (argumente[0] != "--compare" && argumente[0] != "--index" && argumente[0] != "--reconcile")) {
+        cerr << utilizare << endl;
+        return 2;
+    }
+    uint32_t dimensiune_bloc = 1024 * 1024;
+    unsigned fire = max(1u, thread::hardware_concurrency());
+    string cale_raport;
+    try {
+        for (size_t i = 3; i < argumente.size(); i += 2) {
+            if (i + 1 >= argumente.size())
+                throw invalid_argument(argumente[i]);
+            if (argumente[i] == "--bloc")
+                dimensiune_bloc = (uint32_t)max(1ull, min(stoull(argumente[i + 1]), 1024ull * 1024)) * 1024;
+            else if (argumente[i] == "--fire")
+                fire = (unsigned)max(1ull, min(stoull(argumente[i + 1]), 1024ull));
+            else if (argumente[i] == "--raport")
+                cale_raport = argumente[i + 1];
+            else
+                throw invalid_argument(argumente[i]);
+        }
+    }
+    catch (const exception&) {
+        cerr << utilizare << endl;
+        return 2;
+    }
+    initializare_tabele();
+    if (argumente[0] == "--index") {
+        uint64_t erori;
+        IndexCRC index = construiesteIndex(argumente[1], dimensiune_bloc, erori);
+        if (!scrieIndex(index, argumente[2])) {
+            cerr << "Fisierul " << argumente[2] << " nu poate fi scris." << endl;
+            return 2;
+        }
+        cout << index.fisiere.size() << " fisiere indexate, " << erori << " erori de citire." << endl;
+        return erori ? 2 : 0;
+    }
+    if (argumente[0] == "--reconcile") {
+        IndexCRC sursa, replica;
+        RezultatReconciliere rezultat;
+        string eroare;
+        if (!citesteIndex(argumente[1], sursa, eroare) || !citesteIndex(argumente[2], replica, eroare) || !reconciliazaIndexuri(sursa, replica, rezultat, eroare)) {
+            cerr << "Reconcilierea nu se poate face: " << eroare << "." << endl;
+            return 2;
+        }
+        afisareReconciliere(rezultat, cout);
+        if (cale_raport.empty())
+            scrieActiuni(rezultat, cout);
+        else {
+            ofstream raport(cale_raport);
+            scrieActiuni(rezultat, raport);
+            if (!raport) {
+                cerr << "Fisierul " << cale_raport << " nu poate fi scris." << endl;
+                return 2;
+            }
+        }
+        return rezultat.actiuni.empty() ? 0 : 1;
+    }
+    FisierMapat a(argumente[1]), b(argumente[2]);
+    if (!a.deschis() || !b.deschis()) {
+        cerr << "Fisierul " << (a.deschis() ? argumente[2] : argumente[1]) << " nu poate fi deschis." << endl;
+        return 2;
+    }
+    RezultatComparatie rezultat = comparaFisiere(a, b, dimensiune_bloc, fire);
+    afisareComparatie(rezultat, cout);
+    if (!cale_raport.empty()) {
+        ofstream raport(cale_raport);
+        scrieRaportComparatie(rezultat, raport);
+        if (!raport) {
+            cerr << "Fisierul " << cale_raport << " nu poate fi scris." << endl;
+            return 2;
+        }
+    }
+    return rezultat.intervale.empty() ? 0 : 1;
+}
+
+#if !defined(CHECKSUM_FUZZ) && !defined(CHECKSUM_BIBLIOTECA)
+int main(int argc, char* argv[]) {
+    if (argc > 1)
+        return linieComanda(argc, argv);
+
+    enum optiuni { iesire, initializare, calcul_CRC32, calcul_CRC16, calcul_CRC7, calcul_CRC32_async, statistici_planificator, calcul_CRC32_conducta, export_metrici, server_metrici, comutare_histograme, afisare_histograme, test_diferential, deduplicare, jurnal_adaugare, jurnal_recuperare, resincronizare_cadre, experiment_detectie, analiza_puncte_oarbe, verificare_corpus, calcul_CRC32_text, verificare_gzip, inregistrare_urma, reluare_urma, model_inregistrat, verificare_fundal, construire_index, verificare_esantion, calitate_dispersie, benchmark_dispersie, reconciliere_replici, cronologie_conducta };
+    string sir_intrare;
+    int opt;
+
+    cout << "Program de calculare a sumei de control folosind codurile CRC." << endl;
+    cout << "Alegeti una dintre optiuni: " << endl;
+    for (;;) {
+        cout << "1. Initializare tabele de cautare CRC32, CRC16, CRC7, CRC64." << endl;
+        cout << "2. Calculare suma de control CRC32 pentru un sir dat de la tastatura." << endl;
+        cout << "3. Calculare suma de control CRC16 pentru un sir dat de la tastatura." << endl;
+        cout << "4. Calculare suma de control CRC7 pentru un sir dat de la tastatura." << endl;
+        cout << "5. Calculare asincrona a sumei de control CRC32 pentru un fisier." << endl;
+        cout << "6. Statistici planificator (timpi de asteptare pe clase de sarcini)." << endl;
+        cout << "7. Calculare CRC32 pentru un fisier sau director, in paralel, cu memorie limitata." << endl;
+        cout << "8. Export metrici (format Prometheus) intr-un fisier." << endl;
+        cout << "9. Pornire / oprire server de metrici pe un socket Unix." << endl;
+        cout << "10. Pornire/oprire inregistrare latente in histograme HDR." << endl;
+        cout << "11. Afisare percentile latente (p50, p90, p99, p99.9)." << endl;
+        cout << "12. Test diferential: toate kernel-urile si dispecerul comparate cu implementarea de referinta (bit cu bit)." << endl;
+        cout << "13. Scanare deduplicare pe blocuri (index CRC-64) pentru un fisier sau director." << endl;
+        cout << "14. Jurnal: adaugare inregistrare (sir dat de la tastatura)." << endl;
+        cout << "15. Jurnal: scanare de recuperare (trunchiere la prima inregistrare corupta)." << endl;
+        cout << "16. Resincronizare cadre (CRC-16/ARC sau CRC-7/MMC) intr-un fisier cu date corupte." << endl;
+        cout << "17. Experiment detectie erori: inversari de biti si erori de sincronizare (CRC7, CRC16, CRC32)." << endl;
+        cout << "18. Analiza puncte oarbe: zerouri la inceput/sfarsit, trunchiere, extindere (rezultate exacte)." << endl;
+        cout << "19. Verificare corpus: mesaje (cate unul pe linie) al caror CRC nu se schimba la aceste transformari." << endl;
+        cout << "20. Calculare CRC32 pentru continutul decodat al unui fisier text hex sau base64." << endl;
+        cout << "21. Verificare CRC-32 din trailerele unei arhive gzip cu mai multi membri (BGZF decomprimat in paralel)." << endl;
+        cout << "22. Pornire/oprire inregistrare urma de apeluri (lungimi si alinieri), cu salvare intr-un fisier." << endl;
+        cout << "23. Benchmark: reluarea unei urme de apeluri pe fiecare kernel si prin dispecer." << endl;
+        cout << "24. Inregistrare model CRC (din catalog sau dat prin parametri) si calcul cu plierea PCLMUL." << endl;
+        cout << "25. Verificare in fundal a unui manifest \"crc  cale\", cu debit si cota de procesor limitate (pornire/stare/oprire)." << endl;
+        cout << "26. Construire index de blocuri (CRC32 pe fiecare bloc) pentru un fisier sau director." << endl;
+        cout << "27. Verificare prin esantionare a blocurilor dintr-un index, cu interval de incredere pentru fractia corupta." << endl;
+        cout << "28. Calitatea modelelor CRC ca functii de dispersie (avalansa, uniformitate pe galeti, chei structurate)." << endl;
+        cout << "29. Benchmark: tabela de dispersie cu CRC-32C si grupuri SIMD fata de std::unordered_map." << endl;
+        cout << "30. Reconcilierea a doua replici din indexurile lor de blocuri (intervalele de resincronizat)." << endl;
+        cout << "31. Cronologia conductei (optiunea 7): pornire, respectiv oprire si export JSON pentru Perfetto / chrome://tracing." << endl;
+        cout << endl << "0. Iesire program." << endl;
+        cout << "Dati optiunea: ";
+        if (!(cin >> opt)) { /* Sfarsitul intrarii (ex.: comenzi date printr-un pipe in modul batch). */
+            cout << endl;
+            return 0;
+        }
+        switch ((optiuni)opt)
+        {
+        case iesire: cout << "Ati parasit programul."; return 0;
+        case initializare:
+            initializare_tabel32();
+            initializare_tabel16();
+            initializare_tabel7();
+            initializare_tabel64();
+            cout << "Tabelele de cautare CRC32, CRC16, CRC7, CRC64 au fost initializare." << endl;
+            break;
+        case calcul_CRC32:
+            if (!tabel_CRC32_initializat)
+                cout << "Se recomanda initializarea tabelului de cautare CRC32 intai." << endl;
+            else {
+                cout << "Dati sirul de intrare: "; cin.get();
+                getline(cin, sir_intrare);
+                cout << "Cod CRC32 obtinut pentru sirul de intrare " << sir_intrare << ": " << hex << calculCRC32(sir_intrare) << endl;
+            }
+            break;
+        case calcul_CRC16:
+            if (!tabel_CRC16_initializat)
+                cout << "Se recomanda initializarea tabelului de cautare CRC16 intai." << endl;
+            else {
+                cout << "Dati sirul de intrare: "; cin.get();
+                getline(cin, sir_intrare);
+                cout << "Cod CRC16 obtinut pentru sirul de intrare " << sir_intrare << ": " << hex << calculCRC16(sir_intrare) << endl;
+            }
+            break;
+        case calcul_CRC7:
+            if (!tabel_CRC7_initializat)
+                cout << "Se recomanda initializarea tabelului de cautare CRC7 intai." << endl;
+            else {
+                cout << "Dati sirul de intrare: "; cin.get();
+                getline(cin, sir_intrare);
+                cout << "Cod CRC7 obtinut pentru sirul de intrare " << sir_intrare << ": " << hex << (unsigned)calculCRC7(sir_intrare) << endl;
+            }
+                break;
+        case calcul_CRC32_async:
+            if (!tabel_CRC32_initializat)
+                cout << "Se recomanda initializarea tabelului de cautare CRC32 intai." << endl;
+            else {
+                string continut;
+                cout << "Dati calea fisierului: "; cin.get();
+                getline(cin, sir_intrare);
+                if (!citireFisier(sir_intrare, continut)) {
+                    cout << "Fisierul " << sir_intrare << " nu poate fi deschis." << endl;
+                    break;
+                }
+                FluxCRC32 flux;
+                future<void> gata = flux.actualizare_async(continut);
+                auto inceput = chrono::steady_clock::now();
+                /* Firul principal ramane liber cat timp calculul se face pe bazinul de fire. */
+                while (gata.wait_for(chrono::milliseconds(100)) != future_status::ready)
+                    cout << "Se calculeaza... (" << dec << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - inceput).count() << " ms)" << endl;
+                cout << "Cod CRC32 obtinut pentru fisierul " << sir_intrare << " (" << dec << continut.size() << " octeti): " << hex << flux.valoare() << endl;
+            }
+            break;
+        case statistici_planificator: {
+            const char* nume_clase[numar_clase_sarcini] = { "interactive", "masive" };
+            for (int clasa = 0; clasa < numar_clase_sarcini; clasa++) {
+                StatisticiClasa s = bazinCalcul().statistici((ClasaSarcina)clasa);
+                cout << "Sarcini " << nume_clase[clasa] << ": " << dec << s.sarcini << " executate, " << bazinCalcul().lungimeCoada((ClasaSarcina)clasa) << " in coada"
+                    << ", asteptare medie " << (s.sarcini ? s.asteptare_totala_us / s.sarcini : 0) << " us, maxima " << s.asteptare_maxima_us << " us." << endl;
+            }
+            break;
+        }
+        case calcul_CRC32_conducta:
+            if (!tabel_CRC32_initializat)
+                cout << "Se recomanda initializarea tabelului de cautare CRC32 intai." << endl;
+            else {
+                OptiuniConducta optiuni;
+                size_t buget_mb;
+                string cale_iesire;
+                cout << "Dati calea fisierului sau a directorului: "; cin.get();
+                getline(cin, sir_intrare);
+                cout << "Dati bugetul de memorie pentru buffere (MB): ";
+                cin >> buget_mb; cin.get();
+                optiuni.buget_memorie = max<size_t>(1, buget_mb) * 1024 * 1024;
+                cout << "Dati fisierul in care se scriu codurile (gol = ecran): ";
+                getline(cin, cale_iesire);
+                ofstream fisier_iesire;
+                if (!cale_iesire.empty()) {
+                    fisier_iesire.open(cale_iesire);
+                    if (!fisier_iesire) {
+                        cout << "Fisierul " << cale_iesire << " nu poate fi creat." << endl;
+                        break;
+                    }
+                }
+                ConductaCRC conducta(optiuni);
+                RezumatConducta rezumat = conducta.ruleaza(sir_intrare, cale_iesire.empty() ? cout : fisier_iesire);
+                cout << dec << rezumat.fisiere << " fisiere, " << rezumat.octeti << " octeti, " << rezumat.erori << " erori, "
+                    << rezumat.secunde << " s (" << (rezumat.secunde > 0 ? rezumat.octeti / rezumat.secunde / (1024 * 1024) : 0) << " MB/s)." << endl;
+                cout << "Varf memorie rezidenta (peak RSS): " << varfMemorieRezidenta() / (1024 * 1024) << " MB." << endl;
+            }
+            break;
+        case export_metrici:
+            cout << "Dati calea fisierului de metrici: "; cin.get();
+            getline(cin, sir_intrare);
+            if (exportMetriciFisier(sir_intrare))
+                cout << "Metricile au fost scrise in " << sir_intrare << "." << endl;
+            else
+                cout << "Fisierul " << sir_intrare << " nu poate fi scris." << endl;
+            break;
+        case server_metrici:
+#if defined(__unix__) || defined(__APPLE__)
+            if (serverMetrici().esteActiv()) {
+                string cale_socket = serverMetrici().cale();
+                serverMetrici().opreste();
+                cout << "Serverul de metrici de pe " << cale_socket << " a fost oprit." << endl;
+            }
+            else {
+                string eroare;
+                cout << "Dati calea socket-ului Unix: "; cin.get();
+                getline(cin, sir_intrare);
+                if (serverMetrici().porneste(sir_intrare, eroare))
+                    cout << "Metricile pot fi citite cu: curl --unix-socket " << sir_intrare << " http://localhost/metrics" << endl;
+                else
+                    cout << "Socket-ul " << sir_intrare << " nu poate fi creat: " << eroare << "." << endl;
+            }
+#else
+            cout << "Serverul de metrici pe socket Unix nu este disponibil pe acest sistem; folositi exportul in fisier." << endl;
+#endif
+            break;
+        case comutare_histograme:
+            histograme_active.store(!histograme_active.load());
+            cout << "Inregistrarea latentelor este " << (histograme_active.load() ? "pornita." : "oprita.") << endl;
+            break;
+        case afisare_histograme:
+            afisarePercentile(cout);
+            break;
+        case test_diferential:
+            if (!tabel_CRC32_initializat || !tabel_CRC16_initializat || !tabel_CRC7_initializat || !tabel_CRC64_initializat)
+                cout << "Se recomanda initializarea tabelelor de cautare intai." << endl;
+            else {
+                uint64_t iteratii, samanta;
+                cout << "Dati numarul de iteratii: ";
+                cin >> iteratii;
+                cout << "Dati samanta generatorului aleator: ";
+                cin >> samanta;
+                int nepotriviri = testDiferential(iteratii, samanta, cout);
+                if (nepotriviri)
+                    cout << dec << nepotriviri << " nepotriviri fata de implementarea de referinta." << endl;
+                else
+                    cout << "Toate kernel-urile dau aceleasi rezultate ca implementarea de referinta." << endl;
+            }
+            break;
+        case deduplicare:
+            if (!tabel_CRC64_initializat)
+                cout << "Se recomanda initializarea tabelului de cautare CRC64 intai." << endl;
+            else {
+                OptiuniDeduplicare optiuni;
+                string mod, cale_harta;
+                cout << "Dati calea fisierului sau a directorului: "; cin.get();
+                getline(cin, sir_intrare);
+                cout << "Blocuri fixe (f) sau definite de continut (c)? ";
+                getline(cin, mod);
+                optiuni.continut_variabil = mod != "f";
+                cout << "Dati dimensiunea (medie) a blocurilor in octeti: ";
+                cin >> optiuni.dimensiune_medie; cin.get();
+                optiuni.dimensiune_medie = max<size_t>(64, optiuni.dimensiune_medie);
+                cout << "Dati fisierul pentru harta blocurilor (gol = fara harta): ";
+                getline(cin, cale_harta);
+                ofstream harta;
+                if (!cale_harta.empty()) {
+                    harta.open(cale_harta);
+                    if (!harta) {
+                        cout << "Fisierul " << cale_harta << " nu poate fi creat." << endl;
+                        break;
+                    }
+                }
+                ScanerDeduplicare scaner(optiuni);
+                RaportDeduplicare raport = scaner.scaneaza(sir_intrare, cale_harta.empty() ? nullptr : &harta, cout);
+                cout << dec << raport.fisiere << " fisiere, " << raport.blocuri << " blocuri (" << raport.blocuri_unice << " unice), "
+                    << raport.octeti << " octeti, din care " << raport.octeti_duplicati << " duplicati ("
+                    << (raport.octeti ? 100.0 * raport.octeti_duplicati / raport.octeti : 0) << "%)." << endl;
+                cout << "Coliziuni CRC-64: " << raport.coliziuni_crc << ". Timp: " << raport.secunde << " s ("
+                    << (raport.secunde > 0 ? raport.octeti / raport.secunde / (1024 * 1024) : 0) << " MB/s)." << endl;
+            }
+            break;
+        case jurnal_adaugare:
+        case jurnal_recuperare:
+            if (!tabel_CRC32_initializat)
+                cout << "Se recomanda initializarea tabelului de cautare CRC32 intai." << endl;
+            else {
+                string cale_jurnal;
+                cout << "Dati calea jurnalului: "; cin.get();
+                getline(cin, cale_jurnal);
+                JurnalInregistrari jurnal;
+                RaportRecuperare raport;
+                if (!jurnal.deschide(cale_jurnal, raport)) {
+                    cout << "Jurnalul " << cale_jurnal << " nu poate fi deschis sau nu este un jurnal valid." << endl;
+                    break;
+                }
+                cout << "Recuperare: " << dec << raport.inregistrari << " inregistrari valide (" << raport.octeti_valizi << " octeti), "
+                    << raport.octeti_trunchiati << " octeti trunchiati" << (raport.antet_corectat ? ", CRC-ul din antet a fost corectat" : "")
+                    << ", " << raport.secunde << " s." << endl;
+                if ((optiuni)opt == jurnal_adaugare) {
+                    cout << "Dati sirul de intrare: ";
+                    getline(cin, sir_intrare);
+                    if (!jurnal.adauga(sir_intrare.data(), (uint32_t)sir_intrare.size()))
+                        cout << "Inregistrarea nu a putut fi scrisa." << endl;
+                }
+                cout << "CRC32 al jurnalului: " << hex << jurnal.crcJurnal() << endl;
+            }
+            break;
+        case resincronizare_cadre:
+            if (!tabel_CRC16_initializat || !tabel_CRC7_initializat)
+                cout << "Se recomanda initializarea tabelelor de cautare CRC16 si CRC7 intai." << endl;
+            else {
+                OptiuniResincronizare optiuni;
+                string continut, raspuns, cale_iesire;
+                cout << "Dati calea fisierului: "; cin.get();
+                getline(cin, sir_intrare);
+                if (!citireFisier(sir_intrare, continut)) {
+                    cout << "Fisierul " << sir_intrare << " nu poate fi deschis." << endl;
+                    break;
+                }
+                cout << "CRC-ul cadrelor (16 sau 7): ";
+                getline(cin, raspuns);
+                optiuni.algoritm = raspuns == "7" ? algoritm_crc7 : algoritm_crc16;
+                cout << "Cadrele au un octet de lungime la inceput? (d/n): ";
+                getline(cin, raspuns);
+                optiuni.prefix_lungime = raspuns == "d";
+                cout << "Dati lungimea minima si maxima a datelor dintr-un cadru: ";
+                cin >> optiuni.date_minim >> optiuni.date_maxim; cin.get();
+                optiuni.date_minim = max<size_t>(1, optiuni.date_minim);
+                optiuni.date_maxim = max(optiuni.date_minim, optiuni.date_maxim);
+                cout << "Dati fisierul in care se scriu cadrele gasite (gol = ecran): ";
+                getline(cin, cale_iesire);
+
+                auto inceput = chrono::steady_clock::now();
+                ScanerCadre scaner(optiuni);
+                const unsigned char* date = (const unsigned char*)continut.data();
+                vector<CadruGasit> candidati = scaner.candidati(date, continut.size());
+                vector<CadruGasit> cadre = ScanerCadre::selecteaza(candidati, continut.size());
+                double secunde = chrono::duration<double>(chrono::steady_clock::now() - inceput).count();
+
+                ofstream fisier_iesire;
+                if (!cale_iesire.empty())
+                    fisier_iesire.open(cale_iesire);
+                ostream& iesire = cale_iesire.empty() ? cout : fisier_iesire;
+                uint64_t octeti_recuperati = 0;
+                for (const CadruGasit& cadru : cadre) {
+                    iesire << dec << cadru.pozitie << "\t" << cadru.lungime << "\n";
+                    octeti_recuperati += cadru.lungime;
+                }
+                iesire.flush();
+                cout << dec << candidati.size() << " candidati, " << cadre.size() << " cadre alese, " << octeti_recuperati << " din "
+                    << continut.size() << " octeti recuperati, " << secunde << " s." << endl;
+            }
+            break;
+        case experiment_detectie:
+            if (!tabel_CRC32_initializat || !tabel_CRC16_initializat || !tabel_CRC7_initializat)
+                cout << "Se recomanda initializarea tabelelor de cautare intai." << endl;
+            else {
+                size_t lungime;
+                int distanta;
+                uint64_t incercari = 0, samanta = 1;
+                cout << "Dati lungimea mesajelor in octeti (1 sau 2 = exhaustiv, mai mult = Monte Carlo): ";
+                cin >> lungime;
+                lungime = max<size_t>(1, lungime);
+                bool exhaustiv = lungime <= 2;
+                cout << "Dati numarul de biti inversati (distanta Hamming" << (exhaustiv ? ", 1 sau 2" : "") << "): ";
+                cin >> distanta;
+                distanta = max(1, exhaustiv ? min(distanta, 2) : min<int>(distanta, (int)(8 * lungime)));
+                if (!exhaustiv) {
+                    cout << "Dati numarul de incercari si samanta generatorului: ";
+                    cin >> incercari >> samanta;
+                }
+                auto inceput = chrono::steady_clock::now();
+                RezultatExperiment rezultat = experimentDetectie(lungime, exhaustiv, incercari, distanta, samanta);
+                afisareExperiment(rezultat, distanta, cout);
+                cout << "Timp: " << chrono::duration<double>(chrono::steady_clock::now() - inceput).count() << " s." << endl;
+            }
+            break;
+        case analiza_puncte_oarbe: {
+            uint64_t k_maxim;
+            cout << "Dati numarul maxim de octeti k: ";
+            cin >> k_maxim;
+            afisarePuncteOarbe(max<uint64_t>(1, k_maxim), cout);
+            break;
+        }
+        case verificare_corpus:
+            if (!tabel_CRC32_initializat || !tabel_CRC16_initializat || !tabel_CRC7_initializat || !tabel_CRC64_initializat)
+                cout << "Se recomanda initializarea tabelelor de cautare intai." << endl;
+            else {
+                cout << "Dati calea fisierului corpus: "; cin.get();
+                getline(cin, sir_intrare);
+                ifstream corpus(sir_intrare, ios::binary);
+                if (!corpus)
+                    cout << "Fisierul " << sir_intrare << " nu poate fi deschis." << endl;
+                else
+                    verificareCorpus(corpus, cout);
+            }
+            break;
+        case calcul_CRC32_text:
+            if (!tabel_CRC32_initializat)
+                cout << "Se recomanda initializarea tabelelor de cautare intai." << endl;
+            else {
+                char litera;
+                cout << "Formatul textului (h = hex, b = base64): ";
+                cin >> litera;
+                cout << "Dati calea fisierului: "; cin.get();
+                getline(cin, sir_intrare);
+                CRC32 crc = 0;
+                uint64_t octeti = 0;
+                auto inceput = chrono::steady_clock::now();
+                if (!calculCRC32Text(sir_intrare, litera == 'b' ? format_base64 : format_hex, crc, octeti))
+                    cout << "Fisierul " << sir_intrare << " nu poate fi citit sau nu contine text " << (litera == 'b' ? "base64" : "hex") << " valid." << endl;
+                else {
+                    double secunde = chrono::duration<double>(chrono::steady_clock::now() - inceput).count();
+                    cout << "Suma de control CRC32 a celor " << octeti << " octeti decodati este: " << hex << crc << dec << endl;
+                    cout << "Timp: " << secunde << " s (" << (secunde > 0 ? octeti / secunde / 1e6 : 0) << " MB/s)." << endl;
+                }
+            }
+            break;
+        case verificare_gzip:
+#if defined(CHECKSUM_ZLIB)
+            if (!tabel_CRC32_initializat)
+                cout << "Se recomanda initializarea tabelelor de cautare intai." << endl;
+            else {
+                OptiuniGzip optiuni;
+                char litera;
+                cout << "Afisare pentru fiecare membru (d/n): ";
+                cin >> litera;
+                optiuni.detaliat = litera == 'd';
+                cout << "Dati calea arhivei: "; cin.get();
+                getline(cin, sir_intrare);
+                RezumatGzip rezumat = VerificatorGzip(optiuni).ruleaza(sir_intrare, cout);
+                if (rezumat.membri == 0 && !rezumat.citire_completa)
+                    cout << "Fisierul " << sir_intrare << " nu poate fi deschis." << endl;
+                else {
+                    cout << rezumat.membri << " membri (" << rezumat.membri_bgzf << " BGZF), " << rezumat.eronati << " eronati, "
+                        << rezumat.octeti << " octeti decomprimati in " << rezumat.secunde << " s";
+                    if (rezumat.secunde > 0)
+                        cout << " (" << rezumat.octeti / rezumat.secunde / 1e6 << " MB/s)";
+                    cout << "." << endl;
+                    if (!rezumat.citire_completa)
+                        cout << "Scanarea s-a oprit inainte de sfarsitul fisierului." << endl;
+                }
+            }
+#else
+            cout << "Programul a fost compilat fara zlib; verificarea gzip necesita -DCHECKSUM_ZLIB si -lz." << endl;
+#endif
+            break;
+        case inregistrare_urma:
+            if (!urma_apeluri.activa.load()) {
+                size_t capacitate;
+                cout << "Dati numarul maxim de apeluri retinute: ";
+                cin >> capacitate;
+                pornesteUrma(max<size_t>(1, capacitate));
+                cout << "Inregistrarea urmei este pornita." << endl;
+            }
+            else {
+                uint64_t pierdute;
+                vector<IntrareUrma> urma = opresteUrma(pierdute);
+                cout << "Inregistrarea urmei este oprita: " << urma.size() << " apeluri retinute, " << pierdute << " peste capacitate." << endl;
+                cout << "Dati calea fisierului pentru urma: "; cin.get();
+                getline(cin, sir_intrare);
+                if (!salveazaUrma(urma, sir_intrare))
+                    cout << "Fisierul " << sir_intrare << " nu poate fi scris." << endl;
+            }
+            break;
+        case reluare_urma:
+            if (!tabel_CRC32_initializat || !tabel_CRC16_initializat || !tabel_CRC7_initializat || !tabel_CRC64_initializat)
+                cout << "Se recomanda initializarea tabelelor de cautare intai." << endl;
+            else {
+                OptiuniReluare optiuni;
+                char litera;
+                cout << "Dati calea fisierului cu urma: "; cin.get();
+                getline(cin, sir_intrare);
+                vector<IntrareUrma> urma;
+                size_t linie;
+                if (!incarcaUrma(sir_intrare, urma, linie)) {
+                    cout << "Fisierul " << sir_intrare << " nu poate fi citit (linia " << linie << ")." << endl;
+                    break;
+                }
+                cout << "Dati numarul de treceri: ";
+                cin >> optiuni.treceri;
+                cout << "Tabel rece inainte de fiecare mesaj (d/n): ";
+                cin >> litera;
+                optiuni.rece = litera == 'd';
+                RezultatCale rezultate[numar_algoritmi][numar_kerneluri + 1];
+                reluareUrma(urma, optiuni, rezultate);
+                afisareReluare(rezultate, cout);
+            }
+            break;
+        case model_inregistrat: {
+            for (size_t i = 0; i < numar_modele_catalog; i++)
+                cout << i + 1 << ". " << catalog_modele[i].nume << (i % 4 == 3 ? "\n" : "   ");
+            cout << endl << "Dati numarul modelului din catalog, sau 0 pentru un model nou: ";
+            size_t numar;
+            cin >> numar;
+            ModelCRC model = { "model utilizator", 0, 0, 0, false, false, 0, 0 };
+            if (numar >= 1 && numar <= numar_modele_catalog)
+                model = catalog_modele[numar - 1];
+            else {
+                int reflectat_intrare, reflectat_iesire;
+                cout << "Dati latimea (1-64), polinomul, valoarea initiala (hex), reflectare intrare/iesire (0/1) si XOR-ul final (hex): ";
+                cin >> dec >> model.latime >> hex >> model.polinom >> model.initial >> dec >> reflectat_intrare >> reflectat_iesire >> hex >> model.xor_final >> dec;
+                if (!cin || model.latime < 1 || model.latime > 64) {
+                    cout << "Parametri incorecti." << endl;
+                    cin.clear();
+                    cin.ignore(1 << 20, '\n');
+                    break;
+                }
+                model.reflectat_intrare = reflectat_intrare != 0;
+                model.reflectat_iesire = reflectat_iesire != 0;
+            }
+            const MotorCRC& motor = inregistreazaModel(model);
+            int nepotriviri = verificareMotor(motor, 1, cout);
+            cout << motor.descriere().nume << ": CRC(\"123456789\") = " << hex << motor.calcul((const unsigned char*)"123456789", 9) << dec
+                << (nepotriviri ? ", diferente fata de implementarea de referinta." : ", identic cu implementarea de referinta.") << endl;
+            comparatieMotor(motor, cout);
+            cout << "Dati sirul de intrare: "; cin.get();
+            getline(cin, sir_intrare);
+            cout << "Cod " << motor.descriere().nume << " obtinut pentru sirul de intrare " << sir_intrare << ": "
+                << hex << motor.calcul((const unsigned char*)sir_intrare.data(), sir_intrare.length()) << dec << endl;
+            break;
+        }
+        case verificare_fundal:
+            if (verificareFundal().esteActiva()) {
+                char litera;
+                verificareFundal().afiseazaStare(cout);
+                cout << "Oprire (d/n): ";
+                cin >> litera;
+                if (litera == 'd') {
+                    verificareFundal().opreste();
+                    verificareFundal().afiseazaStare(cout);
+                }
+            }
+            else if (!tabel_CRC32_initializat)
+                cout << "Se recomanda initializarea tabelelor de cautare intai." << endl;
+            else {
+                OptiuniFundal optiuni;
+                string cale_raport;
+                double mb_pe_secunda, procent_procesor;
+                verificareFundal().afiseazaStare(cout);
+                cout << "Dati calea manifestului (linii \"crc  cale\", ca la optiunea 7): "; cin.get();
+                getline(cin, sir_intrare);
+                cout << "Dati fisierul in care se scriu nepotrivirile: ";
+                getline(cin, cale_raport);
+                cout << "Dati debitul maxim in MB/s (0 = nelimitat), cota de procesor (%) si pragul de presiune PSI (%, 0 = fara adaptare): ";
+                cin >> mb_pe_secunda >> procent_procesor >> optiuni.prag_presiune;
+                optiuni.octeti_pe_secunda = (uint64_t)(max(0.0, mb_pe_secunda) * 1024 * 1024);
+                optiuni.cota_procesor = max(0.01, min(1.0, procent_procesor / 100));
+                if (verificareFundal().porneste(sir_intrare, cale_raport, optiuni))
+                    cout << "Verificarea a pornit in fundal; alegeti din nou optiunea 25 pentru stare sau oprire." << endl;
+                else
+                    cout << "Manifestul sau fisierul de raport nu pot fi deschise." << endl;
+            }
+            break;
+        case construire_index:
+            if (!tabel_CRC32_initializat)
+                cout << "Se recomanda initializarea tabelelor de cautare intai." << endl;
+            else {
+                uint32_t kib;
+                string cale_index;
+                cout << "Dati calea fisierului sau a directorului: "; cin.get();
+                getline(cin, sir_intrare);
+                cout << "Dati fisierul de index: ";
+                getline(cin, cale_index);
+                cout << "Dati dimensiunea blocului (KB): ";
+                cin >> kib;
+                uint64_t erori;
+                auto inceput = chrono::steady_clock::now();
+                IndexCRC index = construiesteIndex(sir_intrare, max<uint32_t>(1, min<uint32_t>(kib, 1024 * 1024)) * 1024, erori);
+                if (!scrieIndex(index, cale_index))
+                    cout << "Fisierul " << cale_index << " nu poate fi scris." << endl;
+                else
+                    cout << index.fisiere.size() << " fisiere indexate, " << erori << " erori de citire ("
+                        << chrono::duration<double>(chrono::steady_clock::now() - inceput).count() << " s)." << endl;
+            }
+            break;
+        case verificare_esantion:
+            if (!tabel_CRC32_initializat || !tabel_CRC64_initializat)
+                cout << "Se recomanda initializarea tabelelor de cautare intai." << endl;
+            else {
+                string radacina, eroare;
+                OptiuniEsantionare optiuni;
+                double procent;
+                IndexCRC index;
+                cout << "Dati fisierul de index: "; cin.get();
+                getline(cin, sir_intrare);
+                if (!citesteIndex(sir_intrare, index, eroare)) {
+                    cout << "Indexul " << sir_intrare << " nu poate fi folosit: " << eroare << "." << endl;
+                    break;
+                }
+                cout << "Dati directorul radacina al datelor: ";
+                getline(cin, radacina);
+                cout << "Dati procentul de blocuri esantionate si samanta: ";
+                cin >> procent >> optiuni.samanta;
+                optiuni.fractie = max(0.0, min(1.0, procent / 100));
+                afisareIncredere(verificareEsantion(index, radacina, optiuni, cout), cout);
+            }
+            break;
+        case calitate_dispersie: {
+            uint64_t chei, samanta;
+            cout << "Dati numarul de chei pentru fiecare tip si samanta generatorului: ";
+            cin >> chei >> samanta;
+            auto inceput = chrono::steady_clock::now();
+            afisareCalitateDispersie(testCalitateDispersie(max<uint64_t>(chei, 2), samanta), cout);
+            cout << "Timp: " << chrono::duration<double>(chrono::steady_clock::now() - inceput).count() << " s." << endl;
+            break;
+        }
+        case benchmark_dispersie: {
+            size_t numar_chei, lungime_cheie;
+            uint64_t samanta;
+            cout << "Dati numarul de chei, lungimea cheilor si samanta generatorului: ";
+            cin >> numar_chei >> lungime_cheie >> samanta;
+            benchmarkDispersie(min<size_t>(numar_chei, UINT32_MAX), max<size_t>(lungime_cheie, 8), samanta, cout);
+            break;
+        }
+        case reconciliere_replici: {
+            if (!tabel_CRC32_initializat) {
+                cout << "Se recomanda initializarea tabelelor de cautare intai." << endl;
+                break;
+            }
+            string cale_replica, cale_iesire, eroare;
+            IndexCRC sursa, replica;
+            RezultatReconciliere rezultat;
+            cout << "Dati indexul sursei: "; cin.get();
+            getline(cin, sir_intrare);
+            cout << "Dati indexul replicii: ";
+            getline(cin, cale_replica);
+            cout << "Dati fisierul pentru lista de actiuni (gol = pe ecran): ";
+            getline(cin, cale_iesire);
+            if (!citesteIndex(sir_intrare, sursa, eroare) || !citesteIndex(cale_replica, replica, eroare) || !reconciliazaIndexuri(sursa, replica, rezultat, eroare)) {
+                cout << "Reconcilierea nu se poate face: " << eroare << "." << endl;
+                break;
+            }
+            afisareReconciliere(rezultat, cout);
+            if (cale_iesire.empty())
+                scrieActiuni(rezultat, cout);
+            else {
+                ofstream iesire_actiuni(cale_iesire);
+                scrieActiuni(rezultat, iesire_actiuni);
+                if (!iesire_actiuni)
+                    cout << "Fisierul " << cale_iesire << " nu poate fi scris." << endl;
+            }
+            break;
+        }
+        case cronologie_conducta:
+            if (!cronologie.activa.load()) {
+                pornesteCronologie();
+                cout << "Cronologia este pornita; rulati optiunea 7, apoi alegeti din nou optiunea 31 pentru export." << endl;
+            }
+            else {
+                cout << "Dati fisierul JSON: "; cin.get();
+                getline(cin, sir_intrare);
+                opresteCronologie();
+                ofstream fisier_json(sir_intrare);
+                uint64_t exportate, pierdute;
+                exportaCronologie(fisier_json, exportate, pierdute);
+                if (!fisier_json)
+                    cout << "Fisierul " << sir_intrare << " nu poate fi scris; cronologia este oprita." << endl;
+                else
+                    cout << exportate << " evenimente exportate, " << pierdute << " pierdute (inele pline); cronologia este oprita." << endl;
+            }
+            break;
+        default: cout << "Optiune incorecta." << endl; break;
+        }
+    }
+}
+#endif